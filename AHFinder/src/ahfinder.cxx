@@ -1,8 +1,12 @@
 #include "discretization.hxx"
+#include "log.hxx"
+#include "output.hxx"
 #include "physics.hxx"
+#include "timers.hxx"
 
 #include <dual.hxx>
 #include <mat.hxx>
+#include <simd.hxx>
 #include <sum.hxx>
 #include <vec.hxx>
 #include <vect.hxx>
@@ -11,15 +15,28 @@
 #include <cctk_Arguments.h>
 #include <cctk_Parameters.h>
 
+#include <mpi.h>
+
+#include <omp.h>
+
 #include <ssht/ssht.h>
 
+#include <algorithm>
 #include <array>
 #include <cassert>
+#include <chrono>
 #include <cmath>
 #include <complex>
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
 #include <limits>
 #include <memory>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace AHFinder {
@@ -45,20 +62,27 @@ template <typename T> struct coords_t {
 };
 
 template <typename T>
-coords_t<T> coords_from_shape(const vec3<T> &pos, const scalar_aij_t<T> &h) {
+coords_t<T> coords_from_shape(const vec3<T> &pos, const scalar_aij_t<T> &h,
+                              const rows_t &rows = {}) {
   DECLARE_CCTK_PARAMETERS;
-  using std::cos, std::sin;
   const geom_t &geom = h.geom;
+  const rows_t rs = rows.clamp(geom.ntheta);
   coords_t<T> coords(geom);
-  for (int i = 0; i < geom.ntheta; ++i) {
+  const T *restrict const hp = h().data();
+  T *restrict const xp = coords.x(0)().data();
+  T *restrict const yp = coords.x(1)().data();
+  T *restrict const zp = coords.x(2)().data();
+#pragma omp parallel for
+  for (int i = rs.imin; i < rs.imax; ++i) {
+    const T sin_theta = geom.sin_theta[i];
+    const T cos_theta = geom.cos_theta[i];
 #pragma omp simd
     for (int j = 0; j < geom.nphi; ++j) {
-      const T r = h()(i, j);
-      const T theta = geom.coord_theta(i, j);
-      const T phi = geom.coord_phi(i, j);
-      coords.x(0)()(i, j) = pos(0) + r * sin(theta) * cos(phi);
-      coords.x(1)()(i, j) = pos(1) + r * sin(theta) * sin(phi);
-      coords.x(2)()(i, j) = pos(2) + r * cos(theta);
+      const int n = geom.gind(i, j);
+      const T r = hp[n];
+      xp[n] = pos(0) + r * sin_theta * geom.cos_phi[j];
+      yp[n] = pos(1) + r * sin_theta * geom.sin_phi[j];
+      zp[n] = pos(2) + r * cos_theta;
     }
   }
   return coords;
@@ -115,11 +139,12 @@ template <typename T> struct metric_t {
 };
 
 template <typename T>
-metric_t<T> brill_lindquist_metric(const cGH *const cctkGH,
-                                   const coords_t<T> &coords) {
+metric_t<T> brill_lindquist_metric(const coords_t<T> &coords,
+                                   const rows_t &rows = {}) {
   DECLARE_CCTK_PARAMETERS;
 
   const geom_t &geom = coords.geom;
+  const rows_t rs = rows.clamp(geom.ntheta);
   metric_t<T> metric(geom);
 
   const T M = Brill_Lindquist_mass;
@@ -136,7 +161,7 @@ metric_t<T> brill_lindquist_metric(const cGH *const cctkGH,
       Brill_Lindquist_fz, //
   };
 
-  for (int i = 0; i < geom.ntheta; ++i) {
+  for (int i = rs.imin; i < rs.imax; ++i) {
 #pragma omp simd
     for (int j = 0; j < geom.nphi; ++j) {
       if (0)
@@ -185,23 +210,85 @@ metric_t<T> brill_lindquist_metric(const cGH *const cctkGH,
   return metric;
 }
 
+// The metric quantities that are interpolated: g, its first
+// derivatives, and K
+constexpr int metric_nvars = 6 * (1 + 3 + 1);
+
 template <typename T>
-metric_t<T> interpolate_metric(const cGH *const cctkGH,
-                               const coords_t<T> &coords) {
-  const int gxx_ind = CCTK_VarIndex("ADMBase::gxx");
-  const int gxy_ind = CCTK_VarIndex("ADMBase::gxy");
-  const int gxz_ind = CCTK_VarIndex("ADMBase::gxz");
-  const int gyy_ind = CCTK_VarIndex("ADMBase::gyy");
-  const int gyz_ind = CCTK_VarIndex("ADMBase::gyz");
-  const int gzz_ind = CCTK_VarIndex("ADMBase::gzz");
-  const int kxx_ind = CCTK_VarIndex("ADMBase::kxx");
-  const int kxy_ind = CCTK_VarIndex("ADMBase::kxy");
-  const int kxz_ind = CCTK_VarIndex("ADMBase::kxz");
-  const int kyy_ind = CCTK_VarIndex("ADMBase::kyy");
-  const int kyz_ind = CCTK_VarIndex("ADMBase::kyz");
-  const int kzz_ind = CCTK_VarIndex("ADMBase::kzz");
-
-  constexpr int nvars = 6 * (1 + 3 + 1);
+array<T *, metric_nvars> metric_pointers(metric_t<T> &metric) {
+  return {metric.g(0, 0)().data(),     metric.g(0, 1)().data(),
+          metric.g(0, 2)().data(),     metric.g(1, 1)().data(),
+          metric.g(1, 2)().data(),     metric.g(2, 2)().data(),
+          metric.dg(0, 0)(0)().data(), metric.dg(0, 1)(0)().data(),
+          metric.dg(0, 2)(0)().data(), metric.dg(1, 1)(0)().data(),
+          metric.dg(1, 2)(0)().data(), metric.dg(2, 2)(0)().data(),
+          metric.dg(0, 0)(1)().data(), metric.dg(0, 1)(1)().data(),
+          metric.dg(0, 2)(1)().data(), metric.dg(1, 1)(1)().data(),
+          metric.dg(1, 2)(1)().data(), metric.dg(2, 2)(1)().data(),
+          metric.dg(0, 0)(2)().data(), metric.dg(0, 1)(2)().data(),
+          metric.dg(0, 2)(2)().data(), metric.dg(1, 1)(2)().data(),
+          metric.dg(1, 2)(2)().data(), metric.dg(2, 2)(2)().data(),
+          metric.K(0, 0)().data(),     metric.K(0, 1)().data(),
+          metric.K(0, 2)().data(),     metric.K(1, 1)().data(),
+          metric.K(1, 2)().data(),     metric.K(2, 2)().data()};
+}
+
+// Fill in the lower triangles after the upper ones have been set
+template <typename T> void symmetrize(metric_t<T> &metric) {
+  metric.g(1, 0)() = metric.g(0, 1)();
+  metric.g(2, 0)() = metric.g(0, 2)();
+  metric.g(2, 1)() = metric.g(1, 2)();
+  metric.dg(1, 0)() = metric.dg(0, 1)();
+  metric.dg(2, 0)() = metric.dg(0, 2)();
+  metric.dg(2, 1)() = metric.dg(1, 2)();
+  metric.K(1, 0)() = metric.K(0, 1)();
+  metric.K(2, 0)() = metric.K(0, 2)();
+  metric.K(2, 1)() = metric.K(1, 2)();
+}
+
+// Interpolate grid functions to a set of points with a single request
+// to the driver. Returns results[v][n].
+template <typename T, std::size_t nvars>
+std::vector<std::vector<T> >
+interpolate_points(const cGH *const cctkGH, const array<std::vector<T>, 3> &xs,
+                   const array<CCTK_INT, nvars> &varinds,
+                   const array<CCTK_INT, nvars> &operations) {
+  const int npoints = xs[0].size();
+  std::vector<std::vector<T> > results(nvars, std::vector<T>(npoints));
+  array<T *, nvars> ptrs;
+  for (std::size_t v = 0; v < nvars; ++v)
+    ptrs[v] = results[v].data();
+
+  Interpolate(cctkGH, npoints, xs[0].data(), xs[1].data(), xs[2].data(), nvars,
+              varinds.data(), operations.data(), ptrs.data());
+
+  return results;
+}
+
+// Variable indices of g and K
+inline array<CCTK_INT, 12> metric_varinds() {
+  return {
+      CCTK_VarIndex("ADMBase::gxx"), CCTK_VarIndex("ADMBase::gxy"),
+      CCTK_VarIndex("ADMBase::gxz"), CCTK_VarIndex("ADMBase::gyy"),
+      CCTK_VarIndex("ADMBase::gyz"), CCTK_VarIndex("ADMBase::gzz"),
+      CCTK_VarIndex("ADMBase::kxx"), CCTK_VarIndex("ADMBase::kxy"),
+      CCTK_VarIndex("ADMBase::kxz"), CCTK_VarIndex("ADMBase::kyy"),
+      CCTK_VarIndex("ADMBase::kyz"), CCTK_VarIndex("ADMBase::kzz"),
+  };
+}
+
+// Interpolate all metric quantities, including the derivatives of g
+template <typename T>
+std::vector<std::vector<T> >
+interpolate_metric_points(const cGH *const cctkGH,
+                          const array<std::vector<T>, 3> &xs) {
+  const array<CCTK_INT, 12> inds = metric_varinds();
+  const int gxx_ind = inds[0], gxy_ind = inds[1], gxz_ind = inds[2];
+  const int gyy_ind = inds[3], gyz_ind = inds[4], gzz_ind = inds[5];
+  const int kxx_ind = inds[6], kxy_ind = inds[7], kxz_ind = inds[8];
+  const int kyy_ind = inds[9], kyz_ind = inds[10], kzz_ind = inds[11];
+
+  constexpr int nvars = metric_nvars;
   const array<CCTK_INT, nvars> varinds{
       gxx_ind, gxy_ind, gxz_ind, gyy_ind, gyz_ind, gzz_ind, //
       gxx_ind, gxy_ind, gxz_ind, gyy_ind, gyz_ind, gzz_ind, //
@@ -217,59 +304,416 @@ metric_t<T> interpolate_metric(const cGH *const cctkGH,
       0, 0, 0, 0, 0, 0, //
   };
 
-  const geom_t &geom = coords.geom;
-  metric_t<T> metric(geom);
-  array<T *, nvars> ptrs{
-      metric.g(0, 0)().data(),     metric.g(0, 1)().data(),
-      metric.g(0, 2)().data(),     metric.g(1, 1)().data(),
-      metric.g(1, 2)().data(),     metric.g(2, 2)().data(),
-      metric.dg(0, 0)(0)().data(), metric.dg(0, 1)(0)().data(),
-      metric.dg(0, 2)(0)().data(), metric.dg(1, 1)(0)().data(),
-      metric.dg(1, 2)(0)().data(), metric.dg(2, 2)(0)().data(),
-      metric.dg(0, 0)(1)().data(), metric.dg(0, 1)(1)().data(),
-      metric.dg(0, 2)(1)().data(), metric.dg(1, 1)(1)().data(),
-      metric.dg(1, 2)(1)().data(), metric.dg(2, 2)(1)().data(),
-      metric.dg(0, 0)(2)().data(), metric.dg(0, 1)(2)().data(),
-      metric.dg(0, 2)(2)().data(), metric.dg(1, 1)(2)().data(),
-      metric.dg(1, 2)(2)().data(), metric.dg(2, 2)(2)().data(),
-      metric.K(0, 0)().data(),     metric.K(0, 1)().data(),
-      metric.K(0, 2)().data(),     metric.K(1, 1)().data(),
-      metric.K(1, 2)().data(),     metric.K(2, 2)().data()};
-
-  Interpolate(cctkGH, geom.npoints, coords.x(0)().data(), coords.x(1)().data(),
-              coords.x(2)().data(), nvars, varinds.data(), operations.data(),
-              ptrs.data());
+  return interpolate_points(cctkGH, xs, varinds, operations);
+}
 
-  metric.g(1, 0)() = metric.g(0, 1)();
-  metric.g(2, 0)() = metric.g(0, 2)();
-  metric.g(2, 1)() = metric.g(1, 2)();
-  metric.dg(1, 0)() = metric.dg(0, 1)();
-  metric.dg(2, 0)() = metric.dg(0, 2)();
-  metric.dg(2, 1)() = metric.dg(1, 2)();
-  metric.K(1, 0)() = metric.K(0, 1)();
-  metric.K(2, 0)() = metric.K(0, 2)();
-  metric.K(2, 1)() = metric.K(1, 2)();
+// Interpolate the metric onto several surfaces at once. All surface
+// points (on the given theta rows, which are contiguous) are
+// concatenated into a single request to the driver.
+template <typename T>
+std::vector<metric_t<T> >
+interpolate_metric(const cGH *const cctkGH,
+                   const std::vector<coords_t<T> > &coordss,
+                   const rows_t &rows = {}) {
+  // Gather the coordinates of all surfaces
+  const auto point_range = [&](const geom_t &geom) {
+    const rows_t rs = rows.clamp(geom.ntheta);
+    return std::make_pair(rs.imin * geom.nphi,
+                          std::max(0, rs.imax - rs.imin) * geom.nphi);
+  };
+  int npoints = 0;
+  for (const auto &coords : coordss)
+    npoints += point_range(coords.geom).second;
+  array<std::vector<T>, 3> xs;
+  for (int d = 0; d < 3; ++d)
+    xs[d].resize(npoints);
+  {
+    int offset = 0;
+    for (const auto &coords : coordss) {
+      const auto range = point_range(coords.geom);
+      for (int d = 0; d < 3; ++d)
+        std::copy_n(coords.x(d)().data() + range.first, range.second,
+                    xs[d].data() + offset);
+      offset += range.second;
+    }
+  }
 
-  return metric;
+  const auto results = interpolate_metric_points(cctkGH, xs);
+
+  // Scatter the results back to the surfaces
+  std::vector<metric_t<T> > metrics;
+  metrics.reserve(coordss.size());
+  int offset = 0;
+  for (const auto &coords : coordss) {
+    const geom_t &geom = coords.x(0).geom;
+    const auto range = point_range(geom);
+    metric_t<T> metric(geom);
+    const auto dst = metric_pointers(metric);
+    for (int v = 0; v < metric_nvars; ++v)
+      std::copy_n(results[v].data() + offset, range.second,
+                  dst[v] + range.first);
+    offset += range.second;
+    symmetrize(metric);
+    metrics.push_back(std::move(metric));
+  }
+  assert(offset == npoints);
+
+  return metrics;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Distribution of the theta rows of the surfaces over the processes.
+// Each process interpolates the metric and evaluates the expansion only
+// on its own rows. The processes then sum their contributions to the
+// spectral coefficients, so that all of them obtain the same h_lm.
+// Without a communicator, every process works on all rows.
+struct distribution_t {
+  MPI_Comm comm = MPI_COMM_NULL;
+  int rank = 0, size = 1;
+
+  static distribution_t world() {
+    distribution_t dist;
+    dist.comm = MPI_COMM_WORLD;
+    MPI_Comm_rank(dist.comm, &dist.rank);
+    MPI_Comm_size(dist.comm, &dist.size);
+    return dist;
+  }
+
+  // The part [begin, end) of n items owned by a process
+  std::pair<int, int> part(const int n, const int p) const {
+    return {int(std::int64_t(n) * p / size),
+            int(std::int64_t(n) * (p + 1) / size)};
+  }
+  std::pair<int, int> part(const int n) const { return part(n, rank); }
+
+  rows_t rows(const geom_t &geom) const {
+    const auto [imin, imax] = part(geom.ntheta);
+    return {imin, imax};
+  }
+
+  void sum(double *const data, const int count) const {
+    if (comm != MPI_COMM_NULL)
+      MPI_Allreduce(MPI_IN_PLACE, data, count, MPI_DOUBLE, MPI_SUM, comm);
+  }
+  void max(double *const data, const int count) const {
+    if (comm != MPI_COMM_NULL)
+      MPI_Allreduce(MPI_IN_PLACE, data, count, MPI_DOUBLE, MPI_MAX, comm);
+  }
+  // Collect the parts of n items of count values each; every process
+  // has set its own part
+  void gather(double *const data, const int count, const int n) const {
+    if (comm == MPI_COMM_NULL)
+      return;
+    std::vector<int> counts(size), displs(size);
+    for (int p = 0; p < size; ++p) {
+      const auto [begin, end] = part(n, p);
+      counts[p] = (end - begin) * count;
+      displs[p] = begin * count;
+    }
+    MPI_Allgatherv(MPI_IN_PLACE, 0, MPI_DATATYPE_NULL, data, counts.data(),
+                   displs.data(), MPI_DOUBLE, comm);
+  }
+  void sum(int &value) const {
+    if (comm != MPI_COMM_NULL)
+      MPI_Allreduce(MPI_IN_PLACE, &value, 1, MPI_INT, MPI_SUM, comm);
+  }
+  template <typename T> void sum(scalar_alm_t<std::complex<T> > &salm) const {
+    static_assert(std::is_same_v<T, double>);
+    sum(reinterpret_cast<T *>(salm().data()), 2 * salm.geom.ncoeffs);
+  }
+  template <typename T> void sum(vector_alm_t<std::complex<T> > &valm) const {
+    static_assert(std::is_same_v<T, double>);
+    for (int a = 0; a < 2; ++a)
+      sum(reinterpret_cast<T *>(valm(a).data()), 2 * valm.geom.ncoeffs);
+  }
+};
+
+// Minimum, maximum, and maximum absolute value of a scalar that every
+// process has evaluated only on its own rows
+template <typename T> struct extrema_t {
+  T min, max, maxabs;
+};
+template <typename T>
+extrema_t<T> extrema(const scalar_aij_t<T> &saij, const distribution_t &dist) {
+  static_assert(std::is_same_v<T, double>);
+  using std::abs, std::max, std::min;
+  const geom_t &geom = saij.geom;
+  const rows_t rows = dist.rows(geom);
+  T xmin = std::numeric_limits<T>::max();
+  T xmax = std::numeric_limits<T>::lowest();
+  T xmaxabs = 0;
+  for (int n = rows.imin * geom.nphi; n < rows.imax * geom.nphi; ++n) {
+    const T x = saij().data()[n];
+    xmin = min(xmin, x);
+    xmax = max(xmax, x);
+    xmaxabs = max(xmaxabs, abs(x));
+  }
+  // Reduce -min with the maxima
+  array<T, 3> r{-xmin, xmax, xmaxabs};
+  dist.max(r.data(), r.size());
+  return {-r[0], r[1], r[2]};
+}
+
+// A local copy of g and K on uniform Cartesian grids in shells around
+// the horizons. It is taken once per find, so that the iterations do
+// not need to call the driver's interpolator, and it also allows
+// finding horizons on a helper thread while the evolution proceeds.
+// Only grid points that lie within a shell are stored. The metric and
+// the derivatives of g are evaluated from a single tricubic Lagrange
+// interpolant.
+template <typename T> struct snapshot_t {
+  static constexpr int nvars = 12; // g, K
+
+  struct box_t {
+    vec3<T> xmin; // location of grid point (0,0,0)
+    T dx;         // grid spacing
+    int n;        // grid points per direction
+    // Row in `values` for each grid point, or -1 if not stored
+    std::vector<int> rows;
+  };
+  std::vector<box_t> boxes;
+  std::vector<array<T, nvars> > values;
+
+  // Evaluate the metric quantities at a point. Returns false if the
+  // point is not covered by the snapshot.
+  bool interpolate(const vec3<T> &x, array<T, metric_nvars> &val) const {
+    using std::floor;
+    for (const auto &box : boxes) {
+      // Stencil, Lagrange weights, and their derivatives, using the
+      // grid points i-1 ... i+2 around the point
+      array<int, 3> i0;
+      array<array<T, 4>, 3> w, dw;
+      bool inside = true;
+      for (int d = 0; d < 3; ++d) {
+        const T s = (x(d) - box.xmin(d)) / box.dx;
+        const T fi = floor(s);
+        const T t = s - fi;
+        i0[d] = int(fi) - 1;
+        inside &= i0[d] >= 0 && i0[d] + 3 < box.n;
+        w[d] = {-t * (t - 1) * (t - 2) / 6, (t + 1) * (t - 1) * (t - 2) / 2,
+                -(t + 1) * t * (t - 2) / 2, (t + 1) * t * (t - 1) / 6};
+        dw[d] = {-(3 * t * t - 6 * t + 2) / (6 * box.dx),
+                 (3 * t * t - 4 * t - 1) / (2 * box.dx),
+                 -(3 * t * t - 2 * t - 2) / (2 * box.dx),
+                 (3 * t * t - 1) / (6 * box.dx)};
+      }
+      if (!inside)
+        continue;
+
+      array<int, 64> rows;
+      for (int k = 0; k < 4; ++k)
+        for (int j = 0; j < 4; ++j)
+          for (int i = 0; i < 4; ++i)
+            rows[i + 4 * (j + 4 * k)] =
+                box.rows[(i0[0] + i) +
+                         box.n * ((i0[1] + j) + box.n * (i0[2] + k))];
+      if (*std::min_element(rows.begin(), rows.end()) < 0)
+        continue;
+
+      // val = [g, dg/dx, dg/dy, dg/dz, K], see metric_pointers
+      for (int v = 0; v < metric_nvars; ++v)
+        val[v] = 0;
+      for (int k = 0; k < 4; ++k) {
+        for (int j = 0; j < 4; ++j) {
+          for (int i = 0; i < 4; ++i) {
+            const T wijk = w[0][i] * w[1][j] * w[2][k];
+            const T dxijk = dw[0][i] * w[1][j] * w[2][k];
+            const T dyijk = w[0][i] * dw[1][j] * w[2][k];
+            const T dzijk = w[0][i] * w[1][j] * dw[2][k];
+            const auto &vals = values[rows[i + 4 * (j + 4 * k)]];
+#pragma omp simd
+            for (int v = 0; v < 6; ++v) {
+              val[v] += wijk * vals[v];
+              val[6 + v] += dxijk * vals[v];
+              val[12 + v] += dyijk * vals[v];
+              val[18 + v] += dzijk * vals[v];
+              val[24 + v] += wijk * vals[6 + v];
+            }
+          }
+        }
+      }
+      return true;
+    }
+    return false;
+  }
+
+  // Evaluate the metric on surfaces (on the given theta rows).
+  // nmissing counts the points that are not covered by the snapshot;
+  // their metric is set to nan.
+  std::vector<metric_t<T> > metrics(const std::vector<coords_t<T> > &coordss,
+                                    const rows_t &rows, int &nmissing) const {
+    std::vector<metric_t<T> > metrics;
+    metrics.reserve(coordss.size());
+    nmissing = 0;
+    for (const auto &coords : coordss) {
+      const geom_t &geom = coords.x(0).geom;
+      const rows_t rs = rows.clamp(geom.ntheta);
+      metric_t<T> metric(geom);
+      const auto dst = metric_pointers(metric);
+      for (int n = rs.imin * geom.nphi; n < rs.imax * geom.nphi; ++n) {
+        const vec3<T> x{coords.x(0)().data()[n], coords.x(1)().data()[n],
+                        coords.x(2)().data()[n]};
+        array<T, metric_nvars> val;
+        if (!interpolate(x, val)) {
+          ++nmissing;
+          val.fill(std::numeric_limits<T>::quiet_NaN());
+        }
+        for (int v = 0; v < metric_nvars; ++v)
+          dst[v][n] = val[v];
+      }
+      symmetrize(metric);
+      metrics.push_back(std::move(metric));
+    }
+    return metrics;
+  }
+};
+
+// Copy g and K in shells around the given surfaces. The shell extends
+// by snapshot_shell_width relative to the surfaces' minimum and maximum
+// radius. Each process interpolates a part of the points, and all
+// processes obtain the whole snapshot.
+template <typename T>
+snapshot_t<T> take_snapshot(const cGH *const cctkGH,
+                            const std::vector<vec3<T> > &poss,
+                            const std::vector<scalar_aij_t<T> > &hijs,
+                            const distribution_t &dist) {
+  DECLARE_CCTK_PARAMETERS;
+  using std::ceil, std::sqrt;
+
+  snapshot_t<T> snapshot;
+  array<std::vector<T>, 3> xs;
+  for (std::size_t h = 0; h < poss.size(); ++h) {
+    const auto &pos = poss[h];
+    const T rmin = minimum(hijs[h]);
+    const T rmax = maximum(hijs[h]);
+    const T rinner = (1 - snapshot_shell_width) * rmin;
+    const T router = (1 + snapshot_shell_width) * rmax;
+
+    typename snapshot_t<T>::box_t box;
+    box.dx = (rmin + rmax) / (2 * snapshot_resolution);
+    // Points within two grid spacings (diagonally) of the shell are
+    // needed for the interpolation stencils
+    const T margin = 2 * sqrt(T(3)) * box.dx;
+    const int nhalf = int(ceil((router + margin) / box.dx));
+    box.n = 2 * nhalf + 1;
+    box.xmin = vec3<T>([&](int d) { return pos(d) - nhalf * box.dx; });
+    box.rows.resize(box.n * box.n * box.n);
+    for (int k = 0; k < box.n; ++k) {
+      for (int j = 0; j < box.n; ++j) {
+        for (int i = 0; i < box.n; ++i) {
+          const vec3<T> x{box.xmin(0) + i * box.dx, box.xmin(1) + j * box.dx,
+                          box.xmin(2) + k * box.dx};
+          const T r = sqrt(sum3([&](int d) { return pow2(x(d) - pos(d)); }));
+          int &row = box.rows[i + box.n * (j + box.n * k)];
+          if (r >= rinner - margin && r <= router + margin) {
+            row = xs[0].size();
+            for (int d = 0; d < 3; ++d)
+              xs[d].push_back(x(d));
+          } else {
+            row = -1;
+          }
+        }
+      }
+    }
+    snapshot.boxes.push_back(std::move(box));
+  }
+
+  constexpr int nvars = snapshot_t<T>::nvars;
+  const int npoints = xs[0].size();
+  const auto [begin, end] = dist.part(npoints);
+  array<std::vector<T>, 3> my_xs;
+  for (int d = 0; d < 3; ++d)
+    my_xs[d].assign(xs[d].begin() + begin, xs[d].begin() + end);
+  array<CCTK_INT, nvars> operations;
+  operations.fill(0);
+  const auto results =
+      interpolate_points(cctkGH, my_xs, metric_varinds(), operations);
+  snapshot.values.resize(npoints);
+  for (int n = begin; n < end; ++n)
+    for (int v = 0; v < nvars; ++v)
+      snapshot.values[n][v] = results[v][n - begin];
+  static_assert(std::is_same_v<T, double>);
+  static_assert(sizeof(array<T, nvars>) == nvars * sizeof(T));
+  dist.gather(reinterpret_cast<T *>(snapshot.values.data()), nvars, npoints);
+
+  CCTK_VINFO("Took metric snapshot with %d points", npoints);
+  return snapshot;
 }
 
+// Where the solver takes the metric from: the analytic test metric,
+// a snapshot, or the grid via the driver's interpolator. If a snapshot
+// does not cover all points, we fall back to the driver if possible.
+// (All processes make the same decision, so that the interpolation
+// remains collective.) The metric is only set on the rows owned by
+// this process.
+template <typename T> struct metric_source_t {
+  const cGH *cctkGH;
+  const snapshot_t<T> *snapshot;
+  distribution_t dist;
+
+  std::vector<metric_t<T> >
+  metrics(const std::vector<coords_t<T> > &coordss) const {
+    DECLARE_CCTK_PARAMETERS;
+    assert(!coordss.empty());
+    const rows_t rows = dist.rows(coordss.at(0).geom);
+    if (use_Brill_Lindquist_metric) {
+      std::vector<metric_t<T> > metrics;
+      metrics.reserve(coordss.size());
+      for (const auto &coords : coordss)
+        metrics.push_back(brill_lindquist_metric(coords, rows));
+      return metrics;
+    }
+    if (snapshot) {
+      int nmissing;
+      auto metrics = snapshot->metrics(coordss, rows, nmissing);
+      dist.sum(nmissing);
+      if (nmissing == 0)
+        return metrics;
+      if (!cctkGH) {
+        log_warn(CCTK_WARN_ALERT,
+                 "%d surface points lie outside the metric snapshot",
+                 nmissing);
+        return metrics;
+      }
+      log_info("%d surface points lie outside the metric snapshot; "
+               "interpolating via the driver",
+               nmissing);
+    }
+    return interpolate_metric(cctkGH, coordss, rows);
+  }
+};
+
 ////////////////////////////////////////////////////////////////////////////////
 
 enum class which_Theta_t { Theta_l, Theta_n };
 
+// Quasi-local measures of a surface
+template <typename T> struct measures_t {
+  T area = 0;
+  // Angular momentum with respect to the flat-space rotations about
+  // the surface's centre (this needs no Killing vectors)
+  vec3<T> spin{0, 0, 0};
+};
+
 template <typename T> struct Theta_t {
   which_Theta_t which_Theta;
   scalar_alm_t<std::complex<T> > Thetalm;
   scalar_alm_t<std::complex<T> > rhoThetalm;
+  measures_t<T> measures; // only set if requested
 };
 
+// The metric needs to be set only on the rows owned by this process
 template <typename T>
 Theta_t<T> expansion(const metric_t<T> &metric, const vec3<T> &pos,
                      const scalar_alm_t<std::complex<T> > &hlm,
-                     const which_Theta_t which_Theta = which_Theta_t::Theta_l) {
+                     const distribution_t &dist,
+                     const which_Theta_t which_Theta = which_Theta_t::Theta_l,
+                     const bool calc_measures = false) {
   DECLARE_CCTK_PARAMETERS;
 
   const geom_t &geom = hlm.geom;
+  const rows_t rows = dist.rows(geom);
 
   // Cartesian coordinates:
   //     x = r \cos\theta \cos\phi
@@ -305,244 +749,275 @@ Theta_t<T> expansion(const metric_t<T> &metric, const vec3<T> &pos,
   //     d\nu/d\phi   = 1
 
   // Evaluate h and its derivatives
-  const scalar_aij_t<T> hij = evaluate(hlm);
-  const vector_alm_t<std::complex<T> > dhlm = gradient(hlm);
-  const vector_aij_t<T> dhij = evaluate(dhlm);
-  if (0)
-    std::cout << "dhij:" << dhij << "\n";
+  const scalar_aij_t<T> hij =
+      timed(stage_t::evaluate, [&] { return evaluate(hlm, rows); });
+  const vector_alm_t<std::complex<T> > dhlm =
+      timed(stage_t::gradient, [&] { return gradient(hlm); });
+  const vector_aij_t<T> dhij =
+      timed(stage_t::evaluate, [&] { return evaluate(dhlm, rows); });
+
+  // The loops over the surface are parallelized over theta rows and
+  // vectorized along phi
+  typedef simd<T> vreal;
+  typedef simdl<T> vbool;
+  constexpr int vsize = std::tuple_size_v<vreal>;
+
+  // Derivatives of the Cartesian coordinates with respect to r, theta,
+  // and phi (the latter divided by sin(theta))
+  const auto calc_dxdr = [](const vreal r, const T sin_theta,
+                            const T cos_theta, const vreal sin_phi,
+                            const vreal cos_phi) {
+    return mat3<vreal>{
+        sin_theta * cos_phi,
+        r * cos_theta * cos_phi,
+        -r * sin_phi, // dx/dphi / sin(theta)
+
+        sin_theta * sin_phi,
+        r * cos_theta * sin_phi,
+        r * cos_phi, // dy/dphi / sin(theta)
+
+        vreal(cos_theta),
+        -r * sin_theta,
+        vreal(0), // dz/dphi / sin(theta)
+    };
+  };
+
+  // Level set function
+  // F(r, theta, phi) = r - h(theta, phi)
+  // const T F = 0
+  const auto calc_dFdx = [](const vreal dhdtheta, const vreal dhdphi,
+                            const mat3<vreal> &drdx) {
+    const mat3<vreal> dFdr{
+        vreal(1),  // dF/dr
+        -dhdtheta, // dF/dtheta
+        -dhdphi,   // dF/dphi / sin(theta)
+
+        vreal(0),
+        vreal(1),
+        vreal(0),
+
+        vreal(0),
+        vreal(0),
+        vreal(1),
+    };
+    return mat3<vreal>([&](int a, int b) {
+      return sum3([&](int x) { return dFdr(a, x) * drdx(x, b); });
+    });
+  };
 
   // s^a
-  const vec3<scalar_aij_t<T> > sij{
+  vec3<scalar_aij_t<T> > sij{
       scalar_aij_t<T>(geom),
       scalar_aij_t<T>(geom),
       scalar_aij_t<T>(geom),
   };
   scalar_aij_t<T> rhoij(geom); // (28)
-  for (int i = 0; i < geom.ntheta; ++i) {
-#pragma omp simd
-    for (int j = 0; j < geom.nphi; ++j) {
-      if (0)
-        std::cout << "i:" << i << " j:" << j << "\n";
+  stage_timer_t pointwise_timer(stage_t::expansion);
+#pragma omp parallel for
+  for (int i = rows.imin; i < rows.imax; ++i) {
+    const T sin_theta = geom.sin_theta[i];
+    const T cos_theta = geom.cos_theta[i];
+    for (int j = 0; j < geom.nphi; j += vsize) {
+      const vbool mask = mask_for_loop_tail<vbool>(j, geom.nphi);
+      const int n = geom.gind(i, j);
+      const auto load = [&](const scalar_aij_t<T> &aij) {
+        return maskz_loadu(mask, &aij().data()[n]);
+      };
 
       // Coordinates
-      const T r = hij()(i, j);
-      const T theta = geom.coord_theta(i, j);
-      const T phi = geom.coord_phi(i, j);
-      if (0)
-        std::cout << "  r:" << r << " theta:" << theta << " phi:" << phi
-                  << "\n";
-      using std::cos, std::sin;
-      const vec3<T> x{
-          pos(0) + r * sin(theta) * cos(phi),
-          pos(1) + r * sin(theta) * sin(phi),
-          pos(2) + r * cos(theta),
-      };
-      if (0)
-        std::cout << "  x:" << x << "\n";
-      const mat3<T> dxdr{
-          sin(theta) * cos(phi),
-          r * cos(theta) * cos(phi),
-          -r * sin(phi), // dx/dphi / sin(theta)
-
-          sin(theta) * sin(phi),
-          r * cos(theta) * sin(phi),
-          r * cos(phi), // dy/dphi / sin(theta)
-
-          cos(theta),
-          -r * sin(theta),
-          0, // dz/dphi / sin(theta)
-      };
-      if (0)
-        std::cout << "  dxdr:" << dxdr << "\n";
-      const mat3<T> drdx = inv(dxdr);
-      if (0)
-        std::cout << "  drdx:" << drdx << "\n";
-      const vec3<T> grad_r([&](int a) { return drdx(0, a); });
-
-      // Level set function
-      // F(r, theta, phi) = r - h(theta, phi)
-      // const T F = 0
-      const mat3<T> dFdr{
-          1,              // dF/dr
-          -dhij(0)(i, j), // dF/dtheta
-          -dhij(1)(i, j), // dF/dphi / sin(theta)
-
-          0,
-          1,
-          0,
-
-          0,
-          0,
-          1,
-      };
-      if (0)
-        std::cout << "  dFdr:" << dFdr << "\n";
-      const mat3<T> dFdx([&](int a, int b) {
-        return sum3([&](int x) { return dFdr(a, x) * drdx(x, b); });
-      });
+      const vreal r = load(hij);
+      const vreal sin_phi = maskz_loadu(mask, &geom.sin_phi[j]);
+      const vreal cos_phi = maskz_loadu(mask, &geom.cos_phi[j]);
+      const mat3<vreal> dxdr =
+          calc_dxdr(r, sin_theta, cos_theta, sin_phi, cos_phi);
+      const mat3<vreal> drdx = inv(dxdr);
+      const vec3<vreal> grad_r([&](int a) { return drdx(0, a); });
+
+      const mat3<vreal> dFdx = calc_dFdx(maskz_loadu(mask, &dhij(0).data()[n]),
+                                         maskz_loadu(mask, &dhij(1).data()[n]),
+                                         drdx);
 
       // Metric
-      const smat3<T> g([&](int a, int b) { return metric.g(a, b)()(i, j); });
-      const smat3<T> gu = inv(g);
+      const smat3<vreal> g([&](int a, int b) { return load(metric.g(a, b)); });
+      const smat3<vreal> gu = inv(g);
 
       // Surface normal
-      const vec3<T> grad_F_F{1, 0, 0};
-
-      const vec3<T> grad_F([&](int a) {
-        return sum3([&](int x) { return grad_F_F(x) * dFdx(x, a); });
-      });
-      const vec3<T> grad_F_u([&](int a) {
+      const vec3<vreal> grad_F([&](int a) { return dFdx(0, a); });
+      const vec3<vreal> grad_F_u([&](int a) {
         return sum3([&](int x) { return gu(a, x) * grad_F(x); });
       });
 
       using std::sqrt;
-      const T len_grad_F =
+      const vreal len_grad_F =
           sqrt(sum3([&](int x) { return grad_F_u(x) * grad_F(x); }));
-      const vec3<T> s = grad_F / len_grad_F;
-      const vec3<T> su(
+      const vec3<vreal> s([&](int a) { return grad_F(a) / len_grad_F; });
+      const vec3<vreal> su(
           [&](int a) { return sum3([&](int x) { return gu(a, x) * s(x); }); });
       for (int a = 0; a < 3; ++a)
-        (T &)sij(a)()(i, j) = s(a);
+        mask_storeu(mask, &sij(a)().data()[n], s(a));
 
       // Auxiliary term rho
-      const T rho = 2 * pow2(r) * len_grad_F / sum3([&](int a, int b) {
-                      return (gu(a, b) - su(a) * su(b)) *
-                             ((a == b) - grad_r(a) * grad_r(b));
-                    });
-      if (0)
-        std::cout << "  rho:" << rho << "\n";
-      rhoij()(i, j) = rho;
+      const vreal rho = T(2) * pow2(r) * len_grad_F /
+                        sum3([&](int a, int b) {
+                          return (gu(a, b) - su(a) * su(b)) *
+                                 (T(a == b) - grad_r(a) * grad_r(b));
+                        });
+      mask_storeu(mask, &rhoij().data()[n], rho);
     }
   }
-
-  const vec3<scalar_alm_t<std::complex<T> > > slm(
-      [&](int a) { return expand(sij(a)); });
-  const vec3<vector_alm_t<std::complex<T> > > dslm(
-      [&](int a) { return gradient(slm(a)); });
-  const vec3<vector_aij_t<T> > dsij([&](int a) { return evaluate(dslm(a)); });
-  if (0)
-    std::cout << "dsij:" << dsij << "\n";
+  pointwise_timer.stop();
+
+  const vec3<scalar_alm_t<std::complex<T> > > slm([&](int a) {
+    auto salm =
+        timed(stage_t::transform, [&] { return expand(sij(a), rows); });
+    dist.sum(salm);
+    return salm;
+  });
+  const vec3<vector_alm_t<std::complex<T> > > dslm([&](int a) {
+    return timed(stage_t::gradient, [&] { return gradient(slm(a)); });
+  });
+  const vec3<vector_aij_t<T> > dsij([&](int a) {
+    return timed(stage_t::evaluate, [&] { return evaluate(dslm(a), rows); });
+  });
+
+  // Expansion Theta_(l) or Theta_(n)
+  const T sign = which_Theta == which_Theta_t::Theta_l ? -1 : +1;
 
   scalar_aij_t<T> Thetaij(geom); // (9), or (22)
   scalar_aij_t<T> rhoThetaij(geom);
-  for (int i = 0; i < geom.ntheta; ++i) {
-#pragma omp simd
-    for (int j = 0; j < geom.nphi; ++j) {
-      if (0)
-        std::cout << "i:" << i << " j:" << j << "\n";
+  // Integrands of the quasi-local measures (per unit solid angle)
+  scalar_aij_t<T> dAij(geom);
+  vec3<scalar_aij_t<T> > dJij{
+      scalar_aij_t<T>(geom),
+      scalar_aij_t<T>(geom),
+      scalar_aij_t<T>(geom),
+  };
+  pointwise_timer.start();
+#pragma omp parallel for
+  for (int i = rows.imin; i < rows.imax; ++i) {
+    const T sin_theta = geom.sin_theta[i];
+    const T cos_theta = geom.cos_theta[i];
+    for (int j = 0; j < geom.nphi; j += vsize) {
+      const vbool mask = mask_for_loop_tail<vbool>(j, geom.nphi);
+      const int n = geom.gind(i, j);
+      const auto load = [&](const scalar_aij_t<T> &aij) {
+        return maskz_loadu(mask, &aij().data()[n]);
+      };
 
       // Coordinates
-      const T r = hij()(i, j);
-      const T theta = geom.coord_theta(i, j);
-      const T phi = geom.coord_phi(i, j);
-      if (0)
-        std::cout << "  r:" << r << " theta:" << theta << " phi:" << phi
-                  << "\n";
-      using std::cos, std::sin;
-      const vec3<T> x{
-          pos(0) + r * sin(theta) * cos(phi),
-          pos(1) + r * sin(theta) * sin(phi),
-          pos(2) + r * cos(theta),
-      };
-      if (0)
-        std::cout << "  x:" << x << "\n";
-      const mat3<T> dxdr{
-          sin(theta) * cos(phi),
-          r * cos(theta) * cos(phi),
-          -r * sin(phi), // dx/dphi / sin(theta)
-
-          sin(theta) * sin(phi),
-          r * cos(theta) * sin(phi),
-          r * cos(phi), // dz/dphi / sin(theta)
-
-          cos(theta),
-          -r * sin(theta),
-          0, // dz/dphi / sin(theta)
-      };
-      if (0)
-        std::cout << "  dxdr:" << dxdr << "\n";
-      const mat3<T> drdx = inv(dxdr);
-      if (0)
-        std::cout << "  drdx:" << drdx << "\n";
-
-      // Level set function
-      // F(r, theta, phi) = r - h(theta, phi)
-      // const T F = 0
-      const mat3<T> dFdr{
-          1,              // dF/dr
-          -dhij(0)(i, j), // dF/dtheta
-          -dhij(1)(i, j), // dF/dphi / sin(theta)
-
-          0,
-          1,
-          0,
-
-          0,
-          0,
-          1,
-      };
-      if (0)
-        std::cout << "  dFdr:" << dFdr << "\n";
-      const mat3<T> dFdx([&](int a, int b) {
-        return sum3([&](int x) { return dFdr(a, x) * drdx(x, b); });
-      });
+      const vreal r = load(hij);
+      const vreal sin_phi = maskz_loadu(mask, &geom.sin_phi[j]);
+      const vreal cos_phi = maskz_loadu(mask, &geom.cos_phi[j]);
+      const mat3<vreal> dxdr =
+          calc_dxdr(r, sin_theta, cos_theta, sin_phi, cos_phi);
+      const mat3<vreal> drdx = inv(dxdr);
+
+      const mat3<vreal> dFdx = calc_dFdx(maskz_loadu(mask, &dhij(0).data()[n]),
+                                         maskz_loadu(mask, &dhij(1).data()[n]),
+                                         drdx);
 
       // Metric
-      const smat3<T> g([&](int a, int b) { return metric.g(a, b)()(i, j); });
-      const smat3<T> K([&](int a, int b) { return metric.K(a, b)()(i, j); });
-      const smat3<T> gu = inv(g);
-      const smat3<vec3<T> > dg([&](int a, int b) {
-        return vec3<T>([&](int c) { return metric.dg(a, b)(c)()(i, j); });
+      const smat3<vreal> g([&](int a, int b) { return load(metric.g(a, b)); });
+      const smat3<vreal> K([&](int a, int b) { return load(metric.K(a, b)); });
+      const smat3<vreal> gu = inv(g);
+      const smat3<vec3<vreal> > dg([&](int a, int b) {
+        return vec3<vreal>([&](int c) { return load(metric.dg(a, b)(c)); });
       });
-      const vec3<smat3<T> > Gamma([&](int a) {
-        return smat3<T>([&](int b, int c) {
+      const vec3<smat3<vreal> > Gamma([&](int a) {
+        return smat3<vreal>([&](int b, int c) {
           return sum3([&](int x) {
-            return gu(a, x) * (dg(x, c)(b) + dg(b, x)(c) - dg(b, c)(x)) / 2;
+            return gu(a, x) * (dg(x, c)(b) + dg(b, x)(c) - dg(b, c)(x)) / T(2);
           });
         });
       });
 
       // Surface normal
-      const vec3<T> s([&](int a) { return sij(a)()(i, j); });
-      if (0)
-        std::cout << "  s:" << s << "\n";
-      const mat3<T> dsdF{
-          0, dsij(0)(0)(i, j), dsij(0)(1)(i, j),
-
-          0, dsij(1)(0)(i, j), dsij(1)(1)(i, j),
-
-          0, dsij(2)(0)(i, j), dsij(2)(1)(i, j),
-      };
-      if (0)
-        std::cout << "  dsdF:" << dsdF << "\n";
-      const mat3<T> dsdx([&](int a, int b) {
+      const vec3<vreal> s([&](int a) { return load(sij(a)); });
+      const mat3<vreal> dsdF([&](int a, int b) {
+        return b == 0 ? vreal(0)
+                      : maskz_loadu(mask, &dsij(a)(b - 1).data()[n]);
+      });
+      const mat3<vreal> dsdx([&](int a, int b) {
         return sum3([&](int x) { return dsdF(a, x) * dFdx(x, b); });
       });
-      if (0)
-        std::cout << "  dsdx:" << dsdx << "\n";
-      const mat3<T> grad_s([&](int a, int b) {
+      const mat3<vreal> grad_s([&](int a, int b) {
         return dsdx(a, b) + sum3([&](int x) { return Gamma(a)(b, x) * s(x); });
       });
-      const vec3<T> su(
+      const vec3<vreal> su(
           [&](int a) { return sum3([&](int x) { return gu(a, x) * s(x); }); });
 
-      // Expansion Theta_(l) or Theta_(n)
-      const int sign = which_Theta == which_Theta_t::Theta_l ? -1 : +1;
-      const T Theta = sum3([&](int x, int y) {
+      const vreal Theta = sum3([&](int x, int y) {
         return (gu(x, y) - su(x) * su(y)) * (grad_s(x, y) + sign * K(x, y));
       });
-      if (0)
-        std::cout << "  Theta:" << Theta << "\n";
-      Thetaij()(i, j) = Theta;
-      const T rho = rhoij()(i, j);
-      rhoThetaij()(i, j) = rho * Theta;
+      mask_storeu(mask, &Thetaij().data()[n], Theta);
+      mask_storeu(mask, &rhoThetaij().data()[n], load(rhoij) * Theta);
+
+      if (calc_measures) {
+        // Tangent vectors e_theta and e_phi / sin(theta)
+        const vreal dhdtheta = maskz_loadu(mask, &dhij(0).data()[n]);
+        const vreal dhdphi = maskz_loadu(mask, &dhij(1).data()[n]);
+        const vec3<vreal> e0(
+            [&](int a) { return dhdtheta * dxdr(a, 0) + dxdr(a, 1); });
+        const vec3<vreal> e1(
+            [&](int a) { return dhdphi * dxdr(a, 0) + dxdr(a, 2); });
+
+        // Area element: sqrt(det q) = sqrt(det q') sin(theta) for the
+        // induced metric q' in the basis e_theta, e_phi / sin(theta)
+        const vreal q00 =
+            sum3([&](int a, int b) { return g(a, b) * e0(a) * e0(b); });
+        const vreal q01 =
+            sum3([&](int a, int b) { return g(a, b) * e0(a) * e1(b); });
+        const vreal q11 =
+            sum3([&](int a, int b) { return g(a, b) * e1(a) * e1(b); });
+        const vreal dA = sqrt(q00 * q11 - pow2(q01));
+        mask_storeu(mask, &dAij().data()[n], dA);
+
+        // J_(d) = 1/(8 pi) \oint (K_ab - K g_ab) phi_(d)^a s^b dA with
+        // phi_(d)^a = epsilon_dca (x^c - pos^c)
+        const vreal trK =
+            sum3([&](int a, int b) { return gu(a, b) * K(a, b); });
+        const vec3<vreal> dx([&](int a) { return r * dxdr(a, 0); });
+        for (int d = 0; d < 3; ++d) {
+          const int d1 = (d + 1) % 3, d2 = (d + 2) % 3;
+          const vec3<vreal> phi([&](int a) {
+            return a == d1 ? -dx(d2) : a == d2 ? dx(d1) : vreal(0);
+          });
+          const vreal dJ = sum3([&](int a, int b) {
+            return (K(a, b) - trK * g(a, b)) * phi(a) * su(b);
+          });
+          mask_storeu(mask, &dJij(d)().data()[n], dA * dJ);
+        }
+      }
     }
   }
 
-  scalar_alm_t<std::complex<T> > Thetalm = expand(Thetaij);
-  scalar_alm_t<std::complex<T> > rhoThetalm = expand(rhoThetaij);
+  pointwise_timer.stop();
+
+  measures_t<T> measures;
+  if (calc_measures) {
+    std::array<T, 4> integrals = timed(stage_t::transform, [&] {
+      return std::array<T, 4>{
+          integrate(dAij, rows),
+          integrate(dJij(0), rows),
+          integrate(dJij(1), rows),
+          integrate(dJij(2), rows),
+      };
+    });
+    dist.sum(integrals.data(), integrals.size());
+    measures.area = integrals[0];
+    for (int d = 0; d < 3; ++d)
+      measures.spin(d) = integrals[1 + d] / (8 * T(M_PI));
+  }
 
-  return Theta_t<T>{which_Theta, std::move(Thetalm), std::move(rhoThetalm)};
+  scalar_alm_t<std::complex<T> > Thetalm =
+      timed(stage_t::transform, [&] { return expand(Thetaij, rows); });
+  scalar_alm_t<std::complex<T> > rhoThetalm =
+      timed(stage_t::transform, [&] { return expand(rhoThetaij, rows); });
+  dist.sum(Thetalm);
+  dist.sum(rhoThetalm);
+
+  return Theta_t<T>{which_Theta, std::move(Thetalm), std::move(rhoThetalm),
+                    measures};
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -566,9 +1041,19 @@ void update_position(vec3<T> &pos, scalar_alm_t<std::complex<T> > &hlm) {
     hlm()(1, m) = 0;
 }
 
+// Step size of the fast flow method for mode l. This approximates the
+// inverse of the linearized expansion in flat space.
+template <typename T> T fast_flow_lambda(const int l) {
+  DECLARE_CCTK_PARAMETERS;
+  const T A = fast_flow_A;
+  const T B = fast_flow_B;
+  // return A / (1 + B * l * (l + 1));
+  return l == 0 ? A : A / (B + T(l * (l + 1)));
+}
+
 template <typename T>
 scalar_alm_t<std::complex<T> >
-step(const cGH *const cctkGH, const vec3<T> &pos, const T &radius,
+step(const vec3<T> &pos, const T &radius,
      const scalar_alm_t<std::complex<T> > &hlm, const Theta_t<T> &Theta) {
   DECLARE_CCTK_PARAMETERS;
 
@@ -580,15 +1065,11 @@ step(const cGH *const cctkGH, const vec3<T> &pos, const T &radius,
   // const T A = alpha / (geom.lmax * (geom.lmax + 1)) + beta;
   // const T B = beta / alpha;
 
-  const T A = fast_flow_A;
-  const T B = fast_flow_B;
-
   scalar_alm_t<std::complex<T> > delta_hlm(geom);
   for (int l = 0; l <= geom.lmax; ++l) {
+    const T lambda = fast_flow_lambda<T>(l);
 #pragma omp simd
     for (int m = -l; m <= l; ++m) {
-      // const T lambda = A / (1 + B * l * (l + 1));
-      const T lambda = l == 0 ? A : A / (B + T(l * (l + 1)));
       delta_hlm()(l, m) = -lambda * rhoThetalm()(l, m);
       // const auto L = geom.lmax;
       // const auto ll1 = l * (l + 1);
@@ -608,27 +1089,70 @@ step(const cGH *const cctkGH, const vec3<T> &pos, const T &radius,
   return delta_hlm;
 }
 
+template <typename T> struct horizon_t {
+  int index;
+  vec3<T> pos;
+  T radius;
+  scalar_alm_t<std::complex<T> > hlm;
+  bool found;
+  int iters;
+  T initial_expansion = NAN; // max |Theta| of the initial guess
+  T expansion = NAN;         // max |Theta| of the last surface
+  measures_t<T> measures; // of the final surface, only set if found
+};
+
+// Evaluate the expansion of several surfaces. The metric is
+// interpolated onto all surfaces with a single call.
 template <typename T>
-void solve(const cGH *const cctkGH, vec3<T> &pos, T &radius,
-           scalar_alm_t<std::complex<T> > hlm) {
-  DECLARE_CCTK_ARGUMENTS;
+std::vector<Theta_t<T> >
+expansions(const metric_source_t<T> &source,
+           const std::vector<vec3<T> > &poss,
+           const std::vector<const scalar_alm_t<std::complex<T> > *> &hlms,
+           const bool calc_measures = false) {
   DECLARE_CCTK_PARAMETERS;
 
-  int iter = 0;
-  for (;;) {
-    if (iter >= max_iters)
-      break;
+  assert(hlms.size() == poss.size());
+
+  std::vector<coords_t<T> > coordss;
+  coordss.reserve(poss.size());
+  for (std::size_t n = 0; n < poss.size(); ++n) {
+    const rows_t rows = source.dist.rows(hlms[n]->geom);
+    const scalar_aij_t<T> hij =
+        timed(stage_t::evaluate, [&] { return evaluate(*hlms[n], rows); });
+    coordss.push_back(timed(stage_t::coordinates, [&] {
+      return coords_from_shape(poss[n], hij, rows);
+    }));
+  }
+
+  const auto metrics =
+      timed(stage_t::metric, [&] { return source.metrics(coordss); });
 
-    ++iter;
-    CCTK_VINFO("iter: %d", iter);
+  std::vector<Theta_t<T> > Thetas;
+  Thetas.reserve(poss.size());
+  for (std::size_t n = 0; n < poss.size(); ++n)
+    Thetas.push_back(expansion(metrics[n], poss[n], *hlms[n], source.dist,
+                               which_Theta_t::Theta_l, calc_measures));
+
+  return Thetas;
+}
+
+// Prepare an iteration: Move the centre of each horizon to its l=1
+// modes, and report the shape
+template <typename T>
+void begin_iteration(const std::vector<horizon_t<T> *> &active,
+                     const distribution_t &dist) {
+  for (const auto horizon : active) {
+    auto &pos = horizon->pos;
+    auto &hlm = horizon->hlm;
 
     update_position(pos, hlm);
-    radius = average(hlm);
+    horizon->radius = average(hlm);
 
-    const auto hij = evaluate(hlm);
-    CCTK_VINFO("    pos=[%g,%g,%g]", pos(0), pos(1), pos(2));
-    CCTK_VINFO("    r_avg=%g   r_min=%g r_max=%g", average(hlm), minimum(hij),
-               maximum(hij));
+    const auto hij = evaluate(hlm, dist.rows(hlm.geom));
+    const auto r = extrema(hij, dist);
+    log_info("  horizon %d:", horizon->index);
+    log_info("    pos=[%g,%g,%g]", pos(0), pos(1), pos(2));
+    log_info("    r_avg=%g   r_min=%g r_max=%g", average(hlm), r.min, r.max);
     if (0) {
       const int lmax = hlm.geom.lmax;
       for (int l = 0; l <= min(4, lmax); ++l) {
@@ -641,42 +1165,402 @@ void solve(const cGH *const cctkGH, vec3<T> &pos, T &radius,
           rmax = max(rmax, imag(hlm()(l, m)));
           r = max(r, abs(hlm()(l, m)));
         }
-        CCTK_VINFO("    |h%dm|=%g   %g   %g", l, r, rmin, rmax);
+        log_info("    |h%dm|=%g   %g   %g", l, r, rmin, rmax);
       }
     }
+  }
+}
 
-    const auto coords = coords_from_shape(pos, hij);
-    const auto metric = use_Brill_Lindquist_metric
-                            ? brill_lindquist_metric(cctkGH, coords)
-                            : interpolate_metric(cctkGH, coords);
-    const auto Theta = expansion(metric, pos, hlm);
-    const auto &Thetalm = Theta.Thetalm;
-    const auto Thetaij = evaluate(Thetalm);
-    CCTK_VINFO("    Θ_avg=%g   Θ_maxabs=%g", average(Thetalm),
-               maxabs(Thetaij()));
+// Fast flow (Gundlach 1998). The horizons that have not yet converged
+// share a single metric interpolation per iteration.
+template <typename T>
+void solve_fast_flow(const metric_source_t<T> &source,
+                     std::vector<horizon_t<T> > &horizons, const T tolerance) {
+  DECLARE_CCTK_PARAMETERS;
 
-    auto delta_hlm = step(cctkGH, pos, radius, hlm, Theta);
-    CCTK_VINFO("    Δr_avg=%g", average(delta_hlm));
+  for (int iter = 1;; ++iter) {
+    std::vector<horizon_t<T> *> active;
+    for (auto &horizon : horizons)
+      if (!horizon.found)
+        active.push_back(&horizon);
+    if (active.empty())
+      break;
 
-    if (0) {
-      using std::abs, std::max, std::min;
-      const int lmax = hlm.geom.lmax;
-      for (int l = 0; l <= min(4, lmax); ++l) {
-        T r = 0.0, rmin = 1.0 / 0.0, rmax = -1.0 / 0.0;
-        for (int m = -l; m <= +l; ++m) {
-          rmin = min(rmin, real(delta_hlm()(l, m)));
-          rmin = min(rmin, imag(delta_hlm()(l, m)));
-          rmax = max(rmax, real(delta_hlm()(l, m)));
-          rmax = max(rmax, imag(delta_hlm()(l, m)));
-          r = max(r, abs(delta_hlm()(l, m)));
+    if (iter > max_iters)
+      break;
+
+    log_info("iter: %d", iter);
+
+    begin_iteration(active, source.dist);
+    std::vector<vec3<T> > poss;
+    std::vector<const scalar_alm_t<std::complex<T> > *> hlms;
+    for (const auto horizon : active) {
+      poss.push_back(horizon->pos);
+      hlms.push_back(&horizon->hlm);
+    }
+    // This evaluation may detect convergence, so that it also yields
+    // the quasi-local measures
+    const auto Thetas = expansions(source, poss, hlms, true);
+
+    for (std::size_t n = 0; n < active.size(); ++n) {
+      const auto horizon = active[n];
+      const auto &pos = horizon->pos;
+      auto &hlm = horizon->hlm;
+
+      const auto &Theta = Thetas[n];
+      const auto &Thetalm = Theta.Thetalm;
+      const T Theta_maxabs =
+          extrema(evaluate(Thetalm, source.dist.rows(Thetalm.geom)),
+                  source.dist)
+              .maxabs;
+      log_info("  horizon %d:", horizon->index);
+      log_info("    Θ_avg=%g   Θ_maxabs=%g", average(Thetalm), Theta_maxabs);
+      if (std::isnan(horizon->initial_expansion))
+        horizon->initial_expansion = Theta_maxabs;
+      horizon->expansion = Theta_maxabs;
+      horizon->iters = iter;
+      // Keep the surface that was just evaluated
+      if (Theta_maxabs <= tolerance) {
+        horizon->found = true;
+        horizon->measures = Theta.measures;
+        log_info("  horizon %d converged", horizon->index);
+        continue;
+      }
+
+      auto delta_hlm = timed(stage_t::step, [&] {
+        return step(pos, horizon->radius, hlm, Theta);
+      });
+      log_info("    Δr_avg=%g", average(delta_hlm));
+
+      if (0) {
+        using std::abs, std::max, std::min;
+        const int lmax = hlm.geom.lmax;
+        for (int l = 0; l <= min(4, lmax); ++l) {
+          T r = 0.0, rmin = 1.0 / 0.0, rmax = -1.0 / 0.0;
+          for (int m = -l; m <= +l; ++m) {
+            rmin = min(rmin, real(delta_hlm()(l, m)));
+            rmin = min(rmin, imag(delta_hlm()(l, m)));
+            rmax = max(rmax, real(delta_hlm()(l, m)));
+            rmax = max(rmax, imag(delta_hlm()(l, m)));
+            r = max(r, abs(delta_hlm()(l, m)));
+          }
+          log_info("    |Δh%dm|=%g   %g   %g", l, r, rmin, rmax);
         }
-        CCTK_VINFO("    |Δh%dm|=%g   %g   %g", l, r, rmin, rmax);
       }
+
+      hlm += delta_hlm;
     }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Newton-Krylov method. The unknowns are the coefficients h_lm, the
+// residual is the coefficients of rho Theta. Jacobian-vector products
+// are finite differences of the expansion. The linear systems are
+// solved with GMRES, right-preconditioned with the fast flow step
+// sizes (i.e. with the flat-space Laplacian).
 
-    hlm = hlm + delta_hlm;
-    if (maxabs(Thetaij()) <= max_expansion)
+// h is real, so the coefficients h_lm form a real vector space; we
+// use the corresponding real inner product
+template <typename T>
+T inner(const scalar_alm_t<std::complex<T> > &xlm,
+        const scalar_alm_t<std::complex<T> > &ylm) {
+  return fmapreduce(
+      [](const auto &x, const auto &y) { return real(conj(x) * y); },
+      [](const T &a, const T &b) { return a + b; }, T(0), xlm, ylm);
+}
+
+template <typename T>
+scalar_alm_t<std::complex<T> >
+precondition(const scalar_alm_t<std::complex<T> > &rlm) {
+  const geom_t &geom = rlm.geom;
+  scalar_alm_t<std::complex<T> > zlm(geom);
+  for (int l = 0; l <= geom.lmax; ++l) {
+    const T lambda = fast_flow_lambda<T>(l);
+#pragma omp simd
+    for (int m = -l; m <= l; ++m)
+      zlm()(l, m) = lambda * rlm()(l, m);
+  }
+  return zlm;
+}
+
+// State of GMRES for one horizon
+template <typename T> struct gmres_t {
+  std::vector<scalar_alm_t<std::complex<T> > > V; // Krylov basis
+  std::vector<std::vector<T> > H; // Hessenberg matrix, stored by column
+  std::vector<T> cs, sn;          // Givens rotations
+  std::vector<T> g;               // rotated right hand side
+  T beta;
+  bool done;
+};
+
+template <typename T>
+void solve_newton_krylov(const metric_source_t<T> &source,
+                         std::vector<horizon_t<T> > &horizons,
+                         const T tolerance) {
+  DECLARE_CCTK_PARAMETERS;
+  using std::abs, std::sqrt;
+
+  for (int iter = 1;; ++iter) {
+    std::vector<horizon_t<T> *> active;
+    for (auto &horizon : horizons)
+      if (!horizon.found)
+        active.push_back(&horizon);
+    if (active.empty())
+      break;
+
+    if (iter > max_iters)
       break;
+
+    log_info("iter: %d", iter);
+
+    // Residual
+    std::vector<scalar_alm_t<std::complex<T> > > Fs;
+    {
+      begin_iteration(active, source.dist);
+      std::vector<vec3<T> > poss;
+      std::vector<const scalar_alm_t<std::complex<T> > *> hlms;
+      for (const auto horizon : active) {
+        poss.push_back(horizon->pos);
+        hlms.push_back(&horizon->hlm);
+      }
+      // This evaluation may detect convergence, so that it also yields
+      // the quasi-local measures
+      auto Thetas = expansions(source, poss, hlms, true);
+
+      std::vector<horizon_t<T> *> unconverged;
+      for (std::size_t n = 0; n < active.size(); ++n) {
+        const auto horizon = active[n];
+        const auto &Thetalm = Thetas[n].Thetalm;
+        const T Theta_maxabs =
+            extrema(evaluate(Thetalm, source.dist.rows(Thetalm.geom)),
+                    source.dist)
+                .maxabs;
+        log_info("  horizon %d:", horizon->index);
+        log_info("    Θ_avg=%g   Θ_maxabs=%g", average(Thetalm), Theta_maxabs);
+        if (std::isnan(horizon->initial_expansion))
+          horizon->initial_expansion = Theta_maxabs;
+        horizon->expansion = Theta_maxabs;
+        horizon->iters = iter;
+        if (Theta_maxabs <= tolerance) {
+          horizon->found = true;
+          horizon->measures = Thetas[n].measures;
+          log_info("  horizon %d converged", horizon->index);
+        } else {
+          unconverged.push_back(horizon);
+          Fs.push_back(std::move(Thetas[n].rhoThetalm));
+        }
+      }
+      active = std::move(unconverged);
+    }
+    if (active.empty())
+      break;
+
+    // The expansions evaluated by GMRES are charged to their own stages
+    const stage_timer_t step_timer(stage_t::step);
+
+    // Solve J delta_h = -F with GMRES, in lockstep for all horizons
+    std::vector<gmres_t<T> > gmress;
+    for (const auto &F : Fs) {
+      const T beta = sqrt(inner(F, F));
+      gmres_t<T> gmres{{}, {}, {}, {}, {beta}, beta, beta == 0};
+      if (beta != 0)
+        gmres.V.push_back(-F / std::complex<T>(beta));
+      gmress.push_back(std::move(gmres));
+    }
+
+    for (int k = 0; k < newton_krylov_dim; ++k) {
+      std::vector<int> todo;
+      for (std::size_t n = 0; n < active.size(); ++n)
+        if (!gmress[n].done)
+          todo.push_back(n);
+      if (todo.empty())
+        break;
+
+      // Evaluate the residual for the perturbed shapes
+      std::vector<T> epss;
+      std::vector<vec3<T> > poss;
+      std::vector<scalar_alm_t<std::complex<T> > > hplms;
+      for (const int n : todo) {
+        const auto horizon = active[n];
+        const auto zlm = precondition(gmress[n].V.at(k));
+        // Perturb the radius by newton_fd_epsilon relative to its
+        // average (Parseval: sum |z_lm|^2 = \int |z|^2)
+        const T zrms = sqrt(inner(zlm, zlm) / (4 * T(M_PI)));
+        const T eps = newton_fd_epsilon * horizon->radius / zrms;
+        epss.push_back(eps);
+        poss.push_back(horizon->pos);
+        hplms.push_back(horizon->hlm);
+        axpy(hplms.back(), std::complex<T>(eps), zlm);
+      }
+      std::vector<const scalar_alm_t<std::complex<T> > *> hplm_ptrs;
+      for (const auto &hplm : hplms)
+        hplm_ptrs.push_back(&hplm);
+      const auto Thetas = expansions(source, poss, hplm_ptrs);
+
+      // Arnoldi step with modified Gram-Schmidt
+      for (std::size_t i = 0; i < todo.size(); ++i) {
+        const int n = todo[i];
+        auto &gmres = gmress[n];
+        auto wlm = Thetas[i].rhoThetalm;
+        wlm -= Fs[n];
+        wlm /= std::complex<T>(epss[i]);
+        std::vector<T> h(k + 2);
+        for (int j = 0; j <= k; ++j) {
+          h[j] = inner(gmres.V[j], wlm);
+          axpy(wlm, std::complex<T>(-h[j]), gmres.V[j]);
+        }
+        h[k + 1] = sqrt(inner(wlm, wlm));
+
+        // Apply the previous Givens rotations to the new column
+        for (int j = 0; j < k; ++j) {
+          const T tmp = gmres.cs[j] * h[j] + gmres.sn[j] * h[j + 1];
+          h[j + 1] = -gmres.sn[j] * h[j] + gmres.cs[j] * h[j + 1];
+          h[j] = tmp;
+        }
+        // Determine the new Givens rotation
+        const T r = sqrt(pow2(h[k]) + pow2(h[k + 1]));
+        const T c = r == 0 ? 1 : h[k] / r;
+        const T s = r == 0 ? 0 : h[k + 1] / r;
+        const T hnext = h[k + 1];
+        gmres.cs.push_back(c);
+        gmres.sn.push_back(s);
+        h[k] = r;
+        h[k + 1] = 0;
+        gmres.g.push_back(-s * gmres.g[k]);
+        gmres.g[k] *= c;
+        gmres.H.push_back(std::move(h));
+
+        const T resid = abs(gmres.g[k + 1]);
+        if (hnext == 0 || resid <= newton_krylov_tol * gmres.beta)
+          gmres.done = true;
+        else
+          gmres.V.push_back(wlm / std::complex<T>(hnext));
+      }
+    }
+
+    // Update the shapes
+    for (std::size_t n = 0; n < active.size(); ++n) {
+      const auto horizon = active[n];
+      auto &hlm = horizon->hlm;
+      const auto &gmres = gmress[n];
+      const int m = gmres.H.size();
+
+      // Solve the triangular system H y = g
+      std::vector<T> y(m);
+      for (int j = m - 1; j >= 0; --j) {
+        T s = gmres.g[j];
+        for (int i = j + 1; i < m; ++i)
+          s -= gmres.H[i][j] * y[i];
+        y[j] = s / gmres.H[j][j];
+      }
+      scalar_alm_t<std::complex<T> > ulm(hlm.geom);
+      ulm = std::complex<T>(0);
+      for (int j = 0; j < m; ++j)
+        axpy(ulm, std::complex<T>(y[j]), gmres.V[j]);
+      auto delta_hlm = precondition(ulm);
+
+      // Limit step size to 10% of the current radius
+      const T h00 = real(hlm()(0, 0));
+      delta_hlm()(0, 0) =
+          clamp(real(delta_hlm()(0, 0)), -0.1 * h00, 0.1 * h00);
+
+      log_info("  horizon %d:", horizon->index);
+      log_info("    GMRES iterations: %d   Δr_avg=%g", m, average(delta_hlm));
+
+      hlm += delta_hlm;
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Iterate until Theta <= tolerance or until max_iters iterations
+template <typename T>
+void solve_level(const metric_source_t<T> &source,
+                 std::vector<horizon_t<T> > &horizons, const T tolerance) {
+  DECLARE_CCTK_PARAMETERS;
+
+  for (auto &horizon : horizons) {
+    horizon.found = false;
+    horizon.iters = 0;
+  }
+
+  if (CCTK_EQUALS(solver, "fast flow"))
+    solve_fast_flow(source, horizons, tolerance);
+  else if (CCTK_EQUALS(solver, "Newton-Krylov"))
+    solve_newton_krylov(source, horizons, tolerance);
+  else
+    CCTK_VERROR("Unknown solver \"%s\"", solver);
+}
+
+// Coarse-to-fine iteration. The low modes of the shape are converged
+// first to a relaxed tolerance on coarser grids with lmax =
+// multires_coarse_lmax, 2 * multires_coarse_lmax, ... (up to half the
+// final lmax), where interpolating the metric and transforming is
+// cheap. Each coarse solution only corrects the modes it can
+// represent; higher modes of the initial guess (e.g. from a warm start)
+// are kept.
+template <typename T>
+void solve(const metric_source_t<T> &source,
+           std::vector<horizon_t<T> > &horizons) {
+  DECLARE_CCTK_PARAMETERS;
+
+  // Recycle the memory of temporary grid functions and coefficients
+  const arena_scope_t arena_scope;
+
+  assert(!horizons.empty());
+  const geom_t &geom = horizons.at(0).hlm.geom;
+
+  std::vector<int> coarse_iters(horizons.size(), 0);
+  for (int lmax = multires_coarse_lmax; lmax > 0 && 2 * lmax <= geom.lmax;
+       lmax *= 2) {
+    const geom_t coarse_geom(lmax + 1);
+    log_info("Coarse level: lmax=%d", lmax);
+
+    std::vector<horizon_t<T> > coarse_horizons;
+    coarse_horizons.reserve(horizons.size());
+    std::vector<scalar_alm_t<std::complex<T> > > coarse_hlms0;
+    coarse_hlms0.reserve(horizons.size());
+    for (const auto &horizon : horizons) {
+      coarse_hlms0.push_back(resample(horizon.hlm, coarse_geom));
+      coarse_horizons.push_back(horizon_t<T>{horizon.index, horizon.pos,
+                                             horizon.radius,
+                                             coarse_hlms0.back(), false, 0});
+    }
+
+    solve_level(source, coarse_horizons, T(multires_max_expansion));
+
+    for (std::size_t n = 0; n < horizons.size(); ++n) {
+      auto &horizon = horizons[n];
+      const auto &coarse_horizon = coarse_horizons[n];
+      horizon.pos = coarse_horizon.pos;
+      horizon.radius = coarse_horizon.radius;
+      auto delta_hlm = coarse_horizon.hlm;
+      delta_hlm -= coarse_hlms0[n];
+      horizon.hlm += resample(delta_hlm, geom);
+      coarse_iters[n] += coarse_horizon.iters;
+      if (std::isnan(horizon.initial_expansion))
+        horizon.initial_expansion = coarse_horizon.initial_expansion;
+    }
+  }
+
+  solve_level(source, horizons, T(max_expansion));
+
+  for (std::size_t n = 0; n < horizons.size(); ++n) {
+    auto &horizon = horizons[n];
+    horizon.iters += coarse_iters[n];
+    if (horizon.found) {
+      const auto &measures = horizon.measures;
+      log_info("Apparent horizon %d found after %d iterations",
+               horizon.index, horizon.iters);
+      log_info("  area=%g   J=[%g,%g,%g]", measures.area, measures.spin(0),
+               measures.spin(1), measures.spin(2));
+    } else
+      log_warn(CCTK_WARN_ALERT,
+               "Apparent horizon %d not found after %d iterations",
+               horizon.index, horizon.iters);
   }
 }
 
@@ -686,29 +1570,448 @@ extern "C" void AHFinder_init(CCTK_ARGUMENTS) {
   DECLARE_CCTK_ARGUMENTS_AHFinder_init;
   DECLARE_CCTK_PARAMETERS;
 
-  *ah_pos_x = initial_pos_x;
-  *ah_pos_y = initial_pos_y;
-  *ah_pos_z = initial_pos_z;
+  for (int n = 0; n < num_horizons; ++n) {
+    ah_pos_x[n] = initial_pos_x[n];
+    ah_pos_y[n] = initial_pos_y[n];
+    ah_pos_z[n] = initial_pos_z[n];
+
+    ah_radius[n] = initial_radius[n];
+
+    ah_nshapes[n] = 0;
+    ah_vel_x[n] = 0;
+    ah_vel_y[n] = 0;
+    ah_vel_z[n] = 0;
+
+    ah_area[n] = 0;
+    ah_mass_irr[n] = 0;
+    ah_spin_x[n] = 0;
+    ah_spin_y[n] = 0;
+    ah_spin_z[n] = 0;
+    ah_mass[n] = 0;
+    ah_chi[n] = 0;
+  }
 
-  *ah_radius = initial_radius;
+  *ah_find_interval = find_every_min;
+  *ah_next_find_iteration = 0;
 }
 
-extern "C" void AHFinder_find(CCTK_ARGUMENTS) {
+// Weights of the Lagrange polynomial through values at the times ts,
+// and of its time derivative, evaluated at time t
+template <typename T>
+std::pair<std::vector<T>, std::vector<T> >
+lagrange_weights(const std::vector<T> &ts, const T t) {
+  const int npoints = ts.size();
+  std::vector<T> ws(npoints), dws(npoints);
+  for (int k = 0; k < npoints; ++k) {
+    T w = 1, dw = 0;
+    for (int l = 0; l < npoints; ++l) {
+      if (l == k)
+        continue;
+      const T f = (t - ts[l]) / (ts[k] - ts[l]);
+      dw = dw * f + w / (ts[k] - ts[l]);
+      w *= f;
+    }
+    ws[k] = w;
+    dws[k] = dw;
+  }
+  return {std::move(ws), std::move(dws)};
+}
+
+// The horizon shapes are stored with this resolution. npoints cannot
+// be steered, so all finds share a single geometry.
+const geom_t &shape_geom() {
+  DECLARE_CCTK_PARAMETERS;
+  static const geom_t geom(npoints);
+  return geom;
+}
+
+// A find that runs on a helper thread while the evolution proceeds.
+// Its results and messages are published at the next call to
+// AHFinder_find, or before checkpointing or terminating.
+struct async_find_t {
+  int iteration;
+  CCTK_REAL time;
+  snapshot_t<CCTK_REAL> snapshot;
+  std::vector<horizon_t<CCTK_REAL> > horizons;
+  log_queue_t log;
+  std::thread thread;
+};
+std::unique_ptr<async_find_t> async_find;
+
+// Publish the results of an asynchronous find, and then start a new
+// find if one is due and start_find is set
+void find_horizons(CCTK_ARGUMENTS, const bool start_find) {
   DECLARE_CCTK_ARGUMENTS_AHFinder_find;
   DECLARE_CCTK_PARAMETERS;
 
-  vec3<CCTK_REAL> pos{*ah_pos_x, *ah_pos_y, *ah_pos_z};
-  CCTK_REAL radius{*ah_radius};
+  sht_plan_t::set_max_memory(std::size_t(max_plan_memory) << 20);
+
+  const geom_t &geom = shape_geom();
+  assert(geom.ncoeffs == npoints * npoints);
+  const auto load_shape = [&](const CCTK_REAL *restrict const hlm_re,
+                              const CCTK_REAL *restrict const hlm_im) {
+    scalar_alm_t<CCTK_COMPLEX> hlm(geom);
+    for (int c = 0; c < geom.ncoeffs; ++c)
+      hlm().data()[c] = CCTK_COMPLEX(hlm_re[c], hlm_im[c]);
+    return hlm;
+  };
+
+  // Predict the centre of a horizon and its velocity at time t from
+  // the last (up to predictor_order + 1) successful finds
+  const auto predict_position = [&](const int n, const CCTK_REAL t) {
+    const std::vector<CCTK_REAL> ts_hist{ah_time[n], ah_time_prev[n],
+                                         ah_time_prev2[n]};
+    const std::vector<vec3<CCTK_REAL> > xs_hist{
+        vec3<CCTK_REAL>{ah_pos_x[n], ah_pos_y[n], ah_pos_z[n]},
+        vec3<CCTK_REAL>{ah_pos_prev_x[n], ah_pos_prev_y[n], ah_pos_prev_z[n]},
+        vec3<CCTK_REAL>{ah_pos_prev2_x[n], ah_pos_prev2_y[n],
+                        ah_pos_prev2_z[n]},
+    };
+    std::vector<CCTK_REAL> ts;
+    std::vector<vec3<CCTK_REAL> > xs;
+    for (int k = 0; k < min(ah_nshapes[n], predictor_order + 1); ++k) {
+      if (k > 0 && !(ts_hist[k] < ts_hist[k - 1]))
+        break;
+      ts.push_back(ts_hist[k]);
+      xs.push_back(xs_hist[k]);
+    }
+    assert(!ts.empty());
+    const auto ws_dws = lagrange_weights(ts, t);
+    const auto &ws = ws_dws.first;
+    const auto &dws = ws_dws.second;
+    const vec3<CCTK_REAL> pos([&](int d) {
+      CCTK_REAL x = 0;
+      for (std::size_t k = 0; k < ts.size(); ++k)
+        x += ws[k] * xs[k](d);
+      return x;
+    });
+    const vec3<CCTK_REAL> vel([&](int d) {
+      CCTK_REAL v = 0;
+      for (std::size_t k = 0; k < ts.size(); ++k)
+        v += dws[k] * xs[k](d);
+      return v;
+    });
+    return std::make_pair(pos, vel);
+  };
+
+  const auto store_results =
+      [&](const std::vector<horizon_t<CCTK_REAL> > &horizons,
+          const int iteration, const CCTK_REAL time) {
+        for (int n = 0; n < num_horizons; ++n) {
+          const auto &horizon = horizons.at(n);
+          const int offset = n * geom.ncoeffs;
+
+          const vec3<CCTK_REAL> pos_last{ah_pos_x[n], ah_pos_y[n],
+                                         ah_pos_z[n]};
+
+          ah_pos_x[n] = horizon.pos(0);
+          ah_pos_y[n] = horizon.pos(1);
+          ah_pos_z[n] = horizon.pos(2);
+          ah_radius[n] = horizon.radius;
+
+          // Remember the shape for the next find. A failed find
+          // invalidates the history; the next find starts again from a
+          // sphere.
+          if (!horizon.found) {
+            ah_nshapes[n] = 0;
+            ah_vel_x[n] = 0;
+            ah_vel_y[n] = 0;
+            ah_vel_z[n] = 0;
+            continue;
+          }
+          if (ah_nshapes[n] >= 2) {
+            ah_pos_prev2_x[n] = ah_pos_prev_x[n];
+            ah_pos_prev2_y[n] = ah_pos_prev_y[n];
+            ah_pos_prev2_z[n] = ah_pos_prev_z[n];
+            ah_time_prev2[n] = ah_time_prev[n];
+          }
+          if (ah_nshapes[n] >= 1) {
+            ah_pos_prev_x[n] = pos_last(0);
+            ah_pos_prev_y[n] = pos_last(1);
+            ah_pos_prev_z[n] = pos_last(2);
+            for (int c = 0; c < geom.ncoeffs; ++c) {
+              ah_hlm_prev_re[offset + c] = ah_hlm_re[offset + c];
+              ah_hlm_prev_im[offset + c] = ah_hlm_im[offset + c];
+            }
+            ah_time_prev[n] = ah_time[n];
+          }
+          for (int c = 0; c < geom.ncoeffs; ++c) {
+            ah_hlm_re[offset + c] = real(horizon.hlm().data()[c]);
+            ah_hlm_im[offset + c] = imag(horizon.hlm().data()[c]);
+          }
+          ah_time[n] = time;
+          ah_nshapes[n] = min(ah_nshapes[n] + 1, 3);
+
+          const vec3<CCTK_REAL> vel = predict_position(n, time).second;
+          ah_vel_x[n] = vel(0);
+          ah_vel_y[n] = vel(1);
+          ah_vel_z[n] = vel(2);
+
+          // Quasi-local measures. The Christodoulou mass combines the
+          // irreducible mass and the spin, M^2 = M_irr^2 + J^2 / (4
+          // M_irr^2).
+          const auto &measures = horizon.measures;
+          using std::sqrt;
+          const CCTK_REAL mass_irr = sqrt(measures.area / (16 * M_PI));
+          const CCTK_REAL J =
+              sqrt(sum3([&](int d) { return pow2(measures.spin(d)); }));
+          const CCTK_REAL mass =
+              sqrt(pow2(mass_irr) + pow2(J) / (4 * pow2(mass_irr)));
+          ah_area[n] = measures.area;
+          ah_mass_irr[n] = mass_irr;
+          ah_spin_x[n] = measures.spin(0);
+          ah_spin_y[n] = measures.spin(1);
+          ah_spin_z[n] = measures.spin(2);
+          ah_mass[n] = mass;
+          ah_chi[n] = J / pow2(mass);
+        }
+
+        // Append the shapes to the time series
+        if (output_shapes && CCTK_MyProc(cctkGH) == 0) {
+          CCTK_CreateDirectory(0755, out_dir);
+          shape_output_t output(std::string(out_dir) + "/" + shapes_file);
+          for (int n = 0; n < num_horizons; ++n) {
+            const auto &horizon = horizons.at(n);
+            const shape_record_t record{
+                n,
+                iteration,
+                time,
+                horizon.found,
+                horizon.iters,
+                {horizon.pos(0), horizon.pos(1), horizon.pos(2)},
+                horizon.radius,
+                horizon.expansion,
+                horizon.hlm.geom.lmax,
+                horizon.hlm.geom.ncoeffs,
+            };
+            output.append(record, horizon.hlm().data());
+          }
+        }
+
+        // Adapt the find interval. Find more often after a failed or
+        // expensive find, and less often while the initial guesses are
+        // good and the horizons move slowly.
+        int interval = *ah_find_interval;
+        bool shorten = false, lengthen = true;
+        for (int n = 0; n < num_horizons; ++n) {
+          const auto &horizon = horizons.at(n);
+          if (!horizon.found || horizon.iters >= cadence_max_iters)
+            shorten = true;
+          if (!(horizon.initial_expansion <= cadence_max_expansion))
+            lengthen = false;
+          // Displacement during a lengthened interval
+          using std::sqrt;
+          const CCTK_REAL speed = sqrt(pow2(ah_vel_x[n]) + pow2(ah_vel_y[n]) +
+                                       pow2(ah_vel_z[n]));
+          if (speed * 2 * interval * cctk_delta_time >
+              cadence_max_displacement * horizon.radius)
+            lengthen = false;
+        }
+        if (shorten)
+          interval /= 2;
+        else if (lengthen)
+          interval *= 2;
+        interval = max(find_every_min, min(find_every_max, interval));
+        if (interval != *ah_find_interval)
+          CCTK_VINFO("Finding horizons every %d iterations", interval);
+        *ah_find_interval = interval;
+        *ah_next_find_iteration = iteration + interval;
+      };
+
+  // Publish the find that was started at the previous step
+  if (async_find) {
+    async_find->thread.join();
+    async_find->log.flush();
+    store_results(async_find->horizons, async_find->iteration,
+                  async_find->time);
+    async_find.reset();
+  }
+
+  if (!start_find || cctk_iteration < *ah_next_find_iteration)
+    return;
+
+  std::vector<horizon_t<CCTK_REAL> > horizons;
+  horizons.reserve(num_horizons);
+  for (int n = 0; n < num_horizons; ++n) {
+    const int offset = n * geom.ncoeffs;
+    vec3<CCTK_REAL> pos{ah_pos_x[n], ah_pos_y[n], ah_pos_z[n]};
+    const CCTK_REAL radius = ah_radius[n];
+
+    // Initial guess: Start from a sphere, or from the previous shape
+    // extrapolated linearly in time
+    scalar_alm_t<CCTK_COMPLEX> hlm =
+        scalar_from_const(geom, CCTK_COMPLEX(radius));
+    if (warm_start && ah_nshapes[n] >= 1) {
+      hlm = load_shape(&ah_hlm_re[offset], &ah_hlm_im[offset]);
+      if (extrapolate_shape && ah_nshapes[n] >= 2 &&
+          ah_time[n] > ah_time_prev[n]) {
+        pos = predict_position(n, cctk_time).first;
+        const auto hlm_prev =
+            load_shape(&ah_hlm_prev_re[offset], &ah_hlm_prev_im[offset]);
+        const CCTK_REAL alpha =
+            (cctk_time - ah_time[n]) / (ah_time[n] - ah_time_prev[n]);
+        hlm = hlm + CCTK_COMPLEX(alpha) * (hlm - hlm_prev);
+      }
+    }
+
+    horizons.push_back(
+        horizon_t<CCTK_REAL>{n, pos, radius, std::move(hlm), false, 0});
+  }
+
+  // Copy the metric around the initial guesses. The processes share
+  // the interpolation, and all of them obtain the same snapshot and
+  // find the same horizons.
+  const bool use_snapshot =
+      !use_Brill_Lindquist_metric &&
+      (find_asynchronously || CCTK_EQUALS(metric_interpolation, "local"));
+  snapshot_t<CCTK_REAL> snapshot;
+  if (use_snapshot) {
+    std::vector<vec3<CCTK_REAL> > poss;
+    std::vector<scalar_aij_t<CCTK_REAL> > hijs;
+    for (const auto &horizon : horizons) {
+      poss.push_back(horizon.pos);
+      hijs.push_back(evaluate(horizon.hlm));
+    }
+    snapshot = take_snapshot(cctkGH, poss, hijs, distribution_t::world());
+  }
+
+  if (!find_asynchronously) {
+    // Distribute the surface points over the processes
+    const distribution_t dist =
+        distribute_surfaces ? distribution_t::world() : distribution_t();
+    solve(metric_source_t<CCTK_REAL>{cctkGH,
+                                     use_snapshot ? &snapshot : nullptr, dist},
+          horizons);
+    store_results(horizons, cctk_iteration, cctk_time);
+    return;
+  }
+
+  // Continue on a helper thread. This thread does not communicate, so
+  // that MPI need not support multiple threads; every process finds
+  // the horizons on its own. It uses only async_num_threads OpenMP
+  // threads, so that it does not compete with the evolution for all
+  // cores, and queues its messages for the main thread.
+  async_find = std::unique_ptr<async_find_t>(
+      new async_find_t{cctk_iteration, cctk_time, std::move(snapshot),
+                       std::move(horizons), log_queue_t(), std::thread()});
+  async_find->thread = std::thread(
+      [state = async_find.get(), nthreads = int(async_num_threads)]() {
+        if (nthreads > 0)
+          omp_set_num_threads(nthreads);
+        const log_queue_scope_t log_scope(state->log);
+        solve(metric_source_t<CCTK_REAL>{nullptr, &state->snapshot,
+                                         distribution_t()},
+              state->horizons);
+      });
+}
+
+extern "C" void AHFinder_find(CCTK_ARGUMENTS) { find_horizons(cctkGH, true); }
+
+// Publish a find that is still running, so that it is neither missing
+// from a checkpoint nor lost at the end of the run
+extern "C" void AHFinder_publish(CCTK_ARGUMENTS) {
+  find_horizons(cctkGH, false);
+}
+
+// Time the stages of finding the horizons in the analytic
+// Brill-Lindquist metric, for npoints = benchmark_min_npoints, 2
+// benchmark_min_npoints - 1, ... up to benchmark_max_npoints. Each find
+// starts from the spheres given by initial_pos and initial_radius. The
+// fastest of benchmark_repeats finds is reported, so that creating the
+// transform plans is not included.
+extern "C" void AHFinder_benchmark(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTS_AHFinder_benchmark;
+  DECLARE_CCTK_PARAMETERS;
+
+  if (!use_Brill_Lindquist_metric)
+    CCTK_VERROR("The benchmark requires use_Brill_Lindquist_metric = yes");
+
+  sht_plan_t::set_max_memory(std::size_t(max_plan_memory) << 20);
+
+  const distribution_t dist =
+      distribute_surfaces ? distribution_t::world() : distribution_t();
+  const metric_source_t<CCTK_REAL> source{cctkGH, nullptr, dist};
+
+  struct result_t {
+    int npoints;
+    bool found;
+    int iters;
+    double total;
+    stage_times_t times;
+  };
+  std::vector<result_t> results;
+
+  for (int nmodes = benchmark_min_npoints; nmodes <= benchmark_max_npoints;
+       nmodes = 2 * nmodes - 1) {
+    const geom_t geom(nmodes);
+    result_t best{nmodes, false, 0, std::numeric_limits<double>::infinity(),
+                  stage_times_t()};
+    for (int repeat = 0; repeat < benchmark_repeats; ++repeat) {
+      std::vector<horizon_t<CCTK_REAL> > horizons;
+      horizons.reserve(num_horizons);
+      for (int n = 0; n < num_horizons; ++n) {
+        const vec3<CCTK_REAL> pos{initial_pos_x[n], initial_pos_y[n],
+                                  initial_pos_z[n]};
+        const CCTK_REAL radius = initial_radius[n];
+        horizons.push_back(horizon_t<CCTK_REAL>{
+            n, pos, radius, scalar_from_const(geom, CCTK_COMPLEX(radius)),
+            false, 0});
+      }
+
+      stage_times_t times;
+      const auto start = std::chrono::steady_clock::now();
+      {
+        const stage_times_scope_t scope(times);
+        solve(source, horizons);
+      }
+      const double total = std::chrono::duration<double>(
+                               std::chrono::steady_clock::now() - start)
+                               .count();
+
+      if (total < best.total) {
+        best.found = true;
+        best.iters = 0;
+        for (const auto &horizon : horizons) {
+          best.found &= horizon.found;
+          best.iters = max(best.iters, horizon.iters);
+        }
+        best.total = total;
+        best.times = times;
+      }
+    }
+    results.push_back(best);
+  }
+
+  // Report at the end, so that the table is not interleaved with the
+  // output of the solver
+  CCTK_VINFO("Benchmark: Brill-Lindquist M=%g, compression [%g,%g,%g], "
+             "solver \"%s\"",
+             Brill_Lindquist_mass, Brill_Lindquist_fx, Brill_Lindquist_fy,
+             Brill_Lindquist_fz, solver);
+  for (const auto &result : results) {
+    const double per_iter = 1.0e+3 / max(result.iters, 1);
+    CCTK_VINFO("  npoints=%d: %s after %d iterations, %.3f ms per iteration",
+               result.npoints, result.found ? "found" : "NOT found",
+               result.iters, result.total * per_iter);
+    for (int stage = 0; stage < nstages; ++stage)
+      CCTK_VINFO("    %-12s %10.3f ms/iter   %5.1f%%   (%ld calls)",
+                 stage_names[stage], result.times.seconds[stage] * per_iter,
+                 100 * result.times.seconds[stage] / result.total,
+                 result.times.calls[stage]);
+    const double other = result.total - result.times.total();
+    CCTK_VINFO("    %-12s %10.3f ms/iter   %5.1f%%", "other",
+               other * per_iter, 100 * other / result.total);
+  }
+}
+
+extern "C" void AHFinder_terminate(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTS_AHFinder_terminate;
 
-  const geom_t geom(npoints);
-  scalar_alm_t<CCTK_COMPLEX> hlm =
-      scalar_from_const(geom, CCTK_COMPLEX(radius));
-  solve(cctkGH, pos, radius, hlm);
+  // AHFinder_publish has already waited for a find that was running
+  assert(!async_find);
 
-  *ah_pos_x = pos(0);
-  *ah_pos_y = pos(1);
-  *ah_pos_z = pos(2);
-  *ah_radius = radius;
+  // Free the transform tables
+  sht_plan_t::clear();
 }
 
 } // namespace AHFinder
@@ -0,0 +1,110 @@
+#ifndef ARENA_HXX
+#define ARENA_HXX
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace AHFinder {
+
+// A memory pool for the arrays of grid functions and coefficients.
+// Finding a horizon creates many temporary arrays of only a few
+// different sizes in every iteration. While an arena_scope_t exists on
+// a thread, arrays that are freed are kept and reused for later
+// allocations of the same size, so that the iterations do not need to
+// call the system allocator. The memory is released when the scope
+// ends.
+//
+// All memory comes from operator new. Arrays may therefore outlive
+// the scope in which they were allocated, or be freed by another
+// thread.
+class arena_t {
+  std::unordered_map<std::size_t, std::vector<void *> > free_lists;
+
+  static arena_t *&current_ref() {
+    static thread_local arena_t *current = nullptr;
+    return current;
+  }
+
+public:
+  arena_t() = default;
+  arena_t(const arena_t &) = delete;
+  arena_t &operator=(const arena_t &) = delete;
+  ~arena_t() {
+    for (const auto &size_list : free_lists)
+      for (void *const ptr : size_list.second)
+        ::operator delete(ptr);
+  }
+
+  // The arena of the innermost active scope on this thread, if any
+  static arena_t *current() { return current_ref(); }
+
+  void *allocate(const std::size_t nbytes) {
+    auto &free_list = free_lists[nbytes];
+    if (free_list.empty())
+      return ::operator new(nbytes);
+    void *const ptr = free_list.back();
+    free_list.pop_back();
+    return ptr;
+  }
+
+  void deallocate(void *const ptr, const std::size_t nbytes) {
+    free_lists[nbytes].push_back(ptr);
+  }
+
+  friend class arena_scope_t;
+};
+
+// Activate an arena on this thread for the lifetime of this object
+class arena_scope_t {
+  arena_t arena;
+  arena_t *const previous;
+
+public:
+  arena_scope_t() : previous(arena_t::current_ref()) {
+    arena_t::current_ref() = &arena;
+  }
+  arena_scope_t(const arena_scope_t &) = delete;
+  arena_scope_t &operator=(const arena_scope_t &) = delete;
+  ~arena_scope_t() { arena_t::current_ref() = previous; }
+};
+
+// Allocator for std::vector that uses the current arena if there is
+// one
+template <typename T> struct arena_allocator {
+  using value_type = T;
+  using is_always_equal = std::true_type;
+
+  arena_allocator() = default;
+  template <typename U> arena_allocator(const arena_allocator<U> &) {}
+
+  T *allocate(const std::size_t n) {
+    const std::size_t nbytes = n * sizeof(T);
+    if (arena_t *const arena = arena_t::current())
+      return static_cast<T *>(arena->allocate(nbytes));
+    return static_cast<T *>(::operator new(nbytes));
+  }
+
+  void deallocate(T *const ptr, const std::size_t n) {
+    const std::size_t nbytes = n * sizeof(T);
+    if (arena_t *const arena = arena_t::current())
+      arena->deallocate(ptr, nbytes);
+    else
+      ::operator delete(ptr);
+  }
+
+  template <typename U> bool operator==(const arena_allocator<U> &) const {
+    return true;
+  }
+  template <typename U> bool operator!=(const arena_allocator<U> &) const {
+    return false;
+  }
+};
+
+template <typename T> using arena_vector = std::vector<T, arena_allocator<T> >;
+
+} // namespace AHFinder
+
+#endif // #ifndef ARENA_HXX
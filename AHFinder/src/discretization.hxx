@@ -1,13 +1,15 @@
 #ifndef DISCRETIZATION_HXX
 #define DISCRETIZATION_HXX
 
-#include <cctk.h>
+#include "arena.hxx"
+#include "sht.hxx"
 
-#include <ssht/ssht.h>
+#include <cctk.h>
 
 #include <algorithm>
 #include <array>
 #include <cassert>
+#include <cmath>
 #include <complex>
 #include <iostream>
 #include <limits>
@@ -39,25 +41,45 @@ struct geom_t {
   const int lmax;
   const int ncoeffs;
 
+  // Coordinates of the grid points, and their sines and cosines.
+  // These are tabulated once so that the loops over the surface do
+  // not need to call the ssht sampling functions or evaluate
+  // trigonometric functions.
+  const std::vector<double> theta, sin_theta, cos_theta; // [i]
+  const std::vector<double> phi, sin_phi, cos_phi;       // [j]
+
   geom_t() = delete;
   geom_t(const int nmodes)
       : nmodes(nmodes), ntheta(nmodes), nphi(2 * nmodes - 1),
-        npoints(ntheta * nphi), lmax(nmodes - 1), ncoeffs(nmodes * nmodes) {}
+        npoints(ntheta * nphi), lmax(nmodes - 1), ncoeffs(nmodes * nmodes),
+        // The last theta may exceed pi by round-off
+        theta(tabulate(ntheta,
+                       [&](int i) {
+                         return std::min(ssht_sampling_mw_t2theta(i, nmodes),
+                                         M_PI);
+                       })),
+        sin_theta(tabulate(ntheta, [&](int i) { return std::sin(theta[i]); })),
+        cos_theta(tabulate(ntheta, [&](int i) { return std::cos(theta[i]); })),
+        phi(tabulate(nphi,
+                     [&](int j) { return ssht_sampling_mw_p2phi(j, nmodes); })),
+        sin_phi(tabulate(nphi, [&](int j) { return std::sin(phi[j]); })),
+        cos_phi(tabulate(nphi, [&](int j) { return std::cos(phi[j]); })) {
+    for (int i = 0; i < ntheta; ++i)
+      assert(theta[i] >= 0 && theta[i] <= M_PI);
+    for (int j = 0; j < nphi; ++j)
+      assert(phi[j] >= 0 && phi[j] < 2 * M_PI);
+  }
 
   double coord_theta(const int i, const int j) const {
     assert(i >= 0 && i < ntheta);
     assert(j >= 0 && j < nphi);
-    const double theta = ssht_sampling_mw_t2theta(i, nmodes);
-    assert(theta >= 0 && theta <= M_PI);
-    return theta;
+    return theta[i];
   }
 
   double coord_phi(const int i, const int j) const {
     assert(i >= 0 && i < ntheta);
     assert(j >= 0 && j < nphi);
-    const double phi = ssht_sampling_mw_p2phi(j, nmodes);
-    assert(phi >= 0 && phi < 2 * M_PI);
-    return phi;
+    return phi[j];
   }
 
   double coord_dtheta(const int i, const int j) const {
@@ -94,6 +116,16 @@ struct geom_t {
     return ind;
   }
 
+private:
+  template <typename F>
+  static std::vector<double> tabulate(const int n, const F &f) {
+    std::vector<double> xs(n);
+    for (int i = 0; i < n; ++i)
+      xs[i] = f(i);
+    return xs;
+  }
+
+public:
   friend std::ostream &operator<<(std::ostream &os, const geom_t &geom) {
     return os << "geom_t{ntheta:" << geom.ntheta << ",nphi:" << geom.nphi
               << ",npoints:" << geom.npoints << ",lmax:" << geom.lmax
@@ -127,6 +159,18 @@ template <template <typename> typename V, typename T> struct vectorspace_mixin {
     fmap_(*(V<T> *)this, [&](auto &x) { x /= a; });
     return *(V<T> *)this;
   }
+  V<T> &operator+=(const V<T> &ys) {
+    fmap_(*(V<T> *)this, [](auto &x, const auto &y) { x += y; }, ys);
+    return *(V<T> *)this;
+  }
+  V<T> &operator-=(const V<T> &ys) {
+    fmap_(*(V<T> *)this, [](auto &x, const auto &y) { x -= y; }, ys);
+    return *(V<T> *)this;
+  }
+  // xs += a * ys in a single pass, without temporaries
+  friend void axpy(V<T> &xs, const T &a, const V<T> &ys) {
+    fmap_(xs, [&](auto &x, const auto &y) { x += a * y; }, ys);
+  }
 
   friend V<T> operator+(const V<T> &xs) {
     return fmap([](auto x) { return +x; }, xs);
@@ -225,7 +269,7 @@ template <typename T> struct alm_t : vectorspace_mixin<alm_t, T> {
   const geom_t &geom;
 
   int spin;
-  std::vector<T> alm;
+  arena_vector<T> alm;
 
   alm_t() = delete;
   alm_t(const geom_t &geom, int spin)
@@ -317,7 +361,7 @@ template <typename T> struct alm_t : vectorspace_mixin<alm_t, T> {
 template <typename T> struct aij_t : vectorspace_mixin<aij_t, T> {
   const geom_t &geom;
 
-  std::vector<T> aij;
+  arena_vector<T> aij;
 
   aij_t() = delete;
   aij_t(const geom_t &geom) : geom(geom), aij(geom.npoints, NAN) {}
@@ -418,45 +462,57 @@ template <typename T> T average(const alm_t<std::complex<T> > &alm) {
   return real(alm(0, 0)) / sqrt(4 * T(M_PI));
 }
 
+// Change the resolution, truncating or zero-padding the coefficients
+template <typename T>
+alm_t<T> resample(const alm_t<T> &alm, const geom_t &geom) {
+  alm_t<T> blm(geom, alm.spin);
+  for (int l = 0; l <= geom.lmax; ++l)
+#pragma omp simd
+    for (int m = -l; m <= l; ++m)
+      blm(l, m) = l <= alm.geom.lmax ? alm(l, m) : T(0);
+  return blm;
+}
+
+// The transforms use cached plans (see sht.hxx) that are equivalent
+// to the respective ssht functions. They can be restricted to some
+// theta rows (see rows_t); values on the other rows are then neither
+// read nor set.
+
 template <typename T>
-alm_t<std::complex<T> > expand(const aij_t<T> &aij, const int spin) {
-  const ssht_dl_method_t method = SSHT_DL_RISBO;
-  const int verbosity = 0; // [0..5]
+alm_t<std::complex<T> > expand(const aij_t<T> &aij, const int spin,
+                               const rows_t &rows = {}) {
+  assert(spin == 0);
   alm_t<std::complex<T> > alm(aij.geom, spin);
-  ssht_core_mw_forward_sov_conv_sym_real(alm.data(), aij.data(),
-                                         alm.geom.nmodes, method, verbosity);
+  sht_plan_t::get(alm.geom.nmodes, spin)
+      ->forward_real(alm.data(), aij.data(), rows);
   return alm;
 }
 
 template <typename T>
 alm_t<std::complex<T> > expand(const aij_t<std::complex<T> > &aij,
-                               const int spin) {
-  const ssht_dl_method_t method = SSHT_DL_RISBO;
-  const int verbosity = 0; // [0..5]
+                               const int spin, const rows_t &rows = {}) {
   alm_t<std::complex<T> > alm(aij.geom, spin);
-  ssht_core_mw_forward_sov_conv_sym(alm.data(), aij.data(), alm.geom.nmodes,
-                                    spin, method, verbosity);
+  sht_plan_t::get(alm.geom.nmodes, spin)->forward(alm.data(), aij.data(), rows);
   return alm;
 }
 
-template <typename T> aij_t<T> evaluate(const alm_t<std::complex<T> > &alm) {
-  const ssht_dl_method_t method = SSHT_DL_RISBO;
-  const int verbosity = 0; // [0..5]
+template <typename T>
+aij_t<T> evaluate(const alm_t<std::complex<T> > &alm,
+                  const rows_t &rows = {}) {
+  assert(alm.spin == 0);
   aij_t<T> aij(alm.geom);
-  ssht_core_mw_inverse_sov_sym_real(aij.data(), alm.data(), aij.geom.nmodes,
-                                    method, verbosity);
+  sht_plan_t::get(aij.geom.nmodes, 0)
+      ->inverse_real(aij.data(), alm.data(), rows);
   return aij;
 }
 
 template <typename T>
 aij_t<std::complex<T> > evaluate(const alm_t<std::complex<T> > &alm,
-                                 const int spin) {
-  const ssht_dl_method_t method = SSHT_DL_RISBO;
-  const int verbosity = 0; // [0..5]
+                                 const int spin, const rows_t &rows = {}) {
   const geom_t &geom = alm.geom;
   aij_t<std::complex<T> > aij(geom);
-  ssht_core_mw_inverse_sov_sym(aij.data(), alm.data(), aij.geom.nmodes, spin,
-                               method, verbosity);
+  sht_plan_t::get(aij.geom.nmodes, spin)
+      ->inverse(aij.data(), alm.data(), rows);
   return aij;
 }
 
@@ -642,37 +698,45 @@ template <typename T> T average(const scalar_alm_t<std::complex<T> > &alm) {
 }
 
 template <typename T>
-scalar_alm_t<std::complex<T> > expand(const scalar_aij_t<T> &saij) {
-  const geom_t &geom = saij.geom;
+scalar_alm_t<T> resample(const scalar_alm_t<T> &salm, const geom_t &geom) {
+  scalar_alm_t<T> rlm(geom);
+  rlm() = resample(salm(), geom);
+  return rlm;
+}
 
-  scalar_aij_t<std::complex<T> > sbij(geom);
-  for (int j = 0; j < geom.nphi; ++j)
-#pragma omp simd
-    for (int i = 0; i < geom.ntheta; ++i)
-      sbij()(i, j) = saij()(i, j);
+// Scalars are real, so that we can use real-valued transforms. Only
+// the coefficients with m >= 0 are used when evaluating, the others
+// are assumed to satisfy a_l,-m = (-1)^m conj(a_lm).
+
+template <typename T>
+scalar_alm_t<std::complex<T> > expand(const scalar_aij_t<T> &saij,
+                                      const rows_t &rows = {}) {
+  const geom_t &geom = saij.geom;
 
   scalar_alm_t<std::complex<T> > salm(geom);
-  salm() = expand(sbij(), 0);
+  salm() = expand(saij(), 0, rows);
 
   return salm;
 }
 
 template <typename T>
-scalar_aij_t<T> evaluate(const scalar_alm_t<std::complex<T> > &salm) {
+scalar_aij_t<T> evaluate(const scalar_alm_t<std::complex<T> > &salm,
+                         const rows_t &rows = {}) {
   const geom_t &geom = salm.geom;
 
-  scalar_aij_t<std::complex<T> > sbij(geom);
-  sbij() = evaluate(salm(), 0);
-
   scalar_aij_t<T> saij(geom);
-  for (int j = 0; j < geom.nphi; ++j)
-#pragma omp simd
-    for (int i = 0; i < geom.ntheta; ++i)
-      saij()(i, j) = real(sbij()(i, j));
+  saij() = evaluate(salm(), rows);
 
   return saij;
 }
 
+// Integrate over the unit sphere, \int f dOmega. When restricted to
+// some rows, this yields the contribution of these rows.
+template <typename T>
+T integrate(const scalar_aij_t<T> &saij, const rows_t &rows = {}) {
+  return sht_plan_t::get(saij.geom.nmodes, 0)->integrate(saij().data(), rows);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 template <typename T> struct vector_aij_t : vectorspace_mixin<vector_aij_t, T> {
@@ -815,67 +879,50 @@ template <typename T> struct vector_alm_t : vectorspace_mixin<vector_alm_t, T> {
   }
 };
 
-template <typename T>
-vector_alm_t<std::complex<T> > expand(const vector_aij_t<T> &vaij) {
-  using namespace std::literals::complex_literals;
+// Vectors are real, so that b1 = conj(b0). With
+// sY_lm^* = (-1)^(s+m) -sY_l,-m, the coefficients of b1 follow from
+// those of b0 via b1_lm = (-1)^(m+1) conj(b0_l,-m), and we need only
+// one transform. Only the coefficients of b0 are used when
+// evaluating.
 
+template <typename T>
+vector_alm_t<std::complex<T> > expand(const vector_aij_t<T> &vaij,
+                                      const rows_t &rows = {}) {
   const geom_t &geom = vaij.geom;
+  const rows_t rs = rows.clamp(geom.ntheta);
 
-  vector_aij_t<std::complex<T> > vbij(geom);
-  for (int j = 0; j < geom.nphi; ++j) {
+  // b0 = m_x a^x with m = (1, i)
+  aij_t<std::complex<T> > b0ij(geom);
+  for (int j = 0; j < geom.nphi; ++j)
 #pragma omp simd
-    for (int i = 0; i < geom.ntheta; ++i) {
-      // b0 =      m_x a^x
-      // b1 = \bar m_x a^x
-
-      // m[p] = {m, \bar m}
-      const std::array<std::array<std::complex<T>, 2>, 2> m{
-          {{{1, +1i}}, {{1, -1i}}}};
-      std::array<std::array<std::complex<T>, 2>, 2> b;
-      for (int p = 0; p < 2; ++p) {
-        std::complex<T> s = 0;
-        for (int x = 0; x < 2; ++x)
-          s += m[p][x] * vaij(x)(i, j);
-        vbij(p)(i, j) = s;
-      }
-    }
-  }
+    for (int i = rs.imin; i < rs.imax; ++i)
+      b0ij(i, j) = std::complex<T>(vaij(0)(i, j), vaij(1)(i, j));
 
   vector_alm_t<std::complex<T> > valm(geom);
-  valm(0) = expand(vbij(0), +1);
-  valm(1) = expand(vbij(1), -1);
+  valm(0) = expand(b0ij, +1, rs);
+  for (int l = 0; l <= geom.lmax; ++l)
+    for (int m = -l; m <= l; ++m)
+      valm(1)(l, m) = T(m % 2 == 0 ? -1 : +1) * conj(valm(0)(l, -m));
 
   return valm;
 }
 
 template <typename T>
-vector_aij_t<T> evaluate(const vector_alm_t<std::complex<T> > &valm) {
-  using namespace std::literals::complex_literals;
-
+vector_aij_t<T> evaluate(const vector_alm_t<std::complex<T> > &valm,
+                         const rows_t &rows = {}) {
   const geom_t &geom = valm.geom;
+  const rows_t rs = rows.clamp(geom.ntheta);
 
-  vector_aij_t<std::complex<T> > vbij(geom);
-  vbij(0) = evaluate(valm(0), +1);
-  vbij(1) = evaluate(valm(1), -1);
+  const aij_t<std::complex<T> > b0ij = evaluate(valm(0), +1, rs);
 
+  // a^x = (Re b0, Im b0)
   vector_aij_t<T> vaij(geom);
-  for (int j = 0; j < geom.nphi; ++j) {
+  for (int j = 0; j < geom.nphi; ++j)
 #pragma omp simd
-    for (int i = 0; i < geom.ntheta; ++i) {
-      // b0 =      m_x a^x
-      // b1 = \bar m_x a^x
-
-      // m[p] = {m, \bar m}
-      const std::array<std::array<std::complex<T>, 2>, 2> minv2{
-          {{{+1, +1}}, {{-1i, +1i}}}}; // minv2[x][p] = 2 * inv(m)
-      for (int x = 0; x < 2; ++x) {
-        std::complex<T> s = 0;
-        for (int p = 0; p < 2; ++p)
-          s += minv2[x][p] * vbij(p)(i, j);
-        vaij(x)(i, j) = real(s) / 2;
-      }
+    for (int i = rs.imin; i < rs.imax; ++i) {
+      vaij(0)(i, j) = real(b0ij(i, j));
+      vaij(1)(i, j) = imag(b0ij(i, j));
     }
-  }
 
   return vaij;
 }
@@ -0,0 +1,108 @@
+#ifndef LOG_HXX
+#define LOG_HXX
+
+#include <cctk.h>
+
+#include <cstdarg>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace AHFinder {
+
+// Info messages and warnings of the solver. The Cactus output functions
+// are only called from the main thread. While a log_queue_scope_t
+// exists on a thread (the helper thread of an asynchronous find), the
+// messages are queued instead, and the main thread emits them later
+// with flush().
+class log_queue_t {
+  struct message_t {
+    int level; // warning level, or -1 for info messages
+    std::string text;
+  };
+  std::vector<message_t> messages;
+
+  static log_queue_t *&current_ref() {
+    static thread_local log_queue_t *current = nullptr;
+    return current;
+  }
+
+public:
+  // The queue of the innermost active scope on this thread, if any
+  static log_queue_t *current() { return current_ref(); }
+
+  void push(const int level, std::string text) {
+    messages.push_back({level, std::move(text)});
+  }
+
+  // Emit and clear the queued messages
+  void flush() {
+    for (const auto &message : messages) {
+      if (message.level < 0)
+        CCTK_INFO(message.text.c_str());
+      else
+        CCTK_WARN(message.level, message.text.c_str());
+    }
+    messages.clear();
+  }
+
+  friend class log_queue_scope_t;
+};
+
+// Queue the messages of this thread for the lifetime of this object
+class log_queue_scope_t {
+  log_queue_t *const previous;
+
+public:
+  log_queue_scope_t(log_queue_t &queue)
+      : previous(log_queue_t::current_ref()) {
+    log_queue_t::current_ref() = &queue;
+  }
+  log_queue_scope_t(const log_queue_scope_t &) = delete;
+  log_queue_scope_t &operator=(const log_queue_scope_t &) = delete;
+  ~log_queue_scope_t() { log_queue_t::current_ref() = previous; }
+};
+
+inline std::string vformat(const char *const fmt, va_list ap) {
+  va_list ap1;
+  va_copy(ap1, ap);
+  const int len = std::vsnprintf(nullptr, 0, fmt, ap1);
+  va_end(ap1);
+  std::string text(len, '\0');
+  std::vsnprintf(text.data(), len + 1, fmt, ap);
+  return text;
+}
+
+inline void log_message(const int level, const char *const fmt, va_list ap) {
+  std::string text = vformat(fmt, ap);
+  if (log_queue_t *const queue = log_queue_t::current())
+    queue->push(level, std::move(text));
+  else if (level < 0)
+    CCTK_INFO(text.c_str());
+  else
+    CCTK_WARN(level, text.c_str());
+}
+
+// Replacements for CCTK_VINFO and CCTK_VWARN
+inline void log_info(const char *const fmt, ...)
+    __attribute__((__format__(__printf__, 1, 2)));
+inline void log_info(const char *const fmt, ...) {
+  va_list ap;
+  va_start(ap, fmt);
+  log_message(-1, fmt, ap);
+  va_end(ap);
+}
+
+inline void log_warn(const int level, const char *const fmt, ...)
+    __attribute__((__format__(__printf__, 2, 3)));
+inline void log_warn(const int level, const char *const fmt, ...) {
+  va_list ap;
+  va_start(ap, fmt);
+  log_message(level, fmt, ap);
+  va_end(ap);
+}
+
+} // namespace AHFinder
+
+#endif // #ifndef LOG_HXX
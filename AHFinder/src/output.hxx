@@ -0,0 +1,99 @@
+#ifndef OUTPUT_HXX
+#define OUTPUT_HXX
+
+#include <cctk.h>
+
+#include <array>
+#include <complex>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <type_traits>
+
+namespace AHFinder {
+
+// Time series of horizon shapes in a compact binary format
+//
+// Every find appends one record per horizon to the data file
+// <base>.dat, and one entry per record to the index file <base>.idx.
+// Both files start with an 8-byte magic string, followed by the
+// records or entries as they are laid out in memory (native byte
+// order, no padding). The index entries have a fixed size; they allow
+// reading (or memory-mapping) the data file without scanning it.
+//
+// Both files are only ever appended to. After a recovery, the finds
+// between the checkpoint and the end of the previous run are written
+// again; readers should use the last record for each (horizon,
+// iteration).
+
+// Header of a record in the data file. It is followed by ncoeffs
+// complex coefficients h_lm (pairs of doubles), ordered as
+// l * (l + 1) + m.
+struct shape_record_t {
+  std::int32_t horizon;   // horizon index
+  std::int32_t iteration; // iteration at which the find started
+  double time;            // time at which the find started
+  std::int32_t found;     // 1 if converged, else 0
+  std::int32_t iters;     // number of iterations of the find
+  double pos[3];          // centre
+  double radius;          // average coordinate radius
+  double expansion;       // max |Theta| on the last surface
+  std::int32_t lmax;
+  std::int32_t ncoeffs; // (lmax + 1)^2
+};
+static_assert(sizeof(shape_record_t) == 72, "");
+static_assert(std::is_trivially_copyable_v<shape_record_t>, "");
+
+// Entry in the index file
+struct shape_index_t {
+  std::int32_t horizon;
+  std::int32_t iteration;
+  double time;
+  std::int64_t offset; // of the record in the data file, in bytes
+};
+static_assert(sizeof(shape_index_t) == 24, "");
+static_assert(std::is_trivially_copyable_v<shape_index_t>, "");
+
+constexpr std::array<char, 8> shape_data_magic{'A', 'H', 'F', 'S',
+                                               'H', 'P', '0', '1'};
+constexpr std::array<char, 8> shape_index_magic{'A', 'H', 'F', 'I',
+                                                'D', 'X', '0', '1'};
+
+class shape_output_t {
+  std::string data_name, index_name;
+  std::ofstream data, index;
+
+  static void open(std::ofstream &file, const std::string &name,
+                   const std::array<char, 8> &magic) {
+    file.open(name, std::ios::binary | std::ios::app);
+    if (!file)
+      CCTK_VERROR("Could not open horizon shape file \"%s\"", name.c_str());
+    file.seekp(0, std::ios::end);
+    if (file.tellp() == 0)
+      file.write(magic.data(), magic.size());
+  }
+
+public:
+  shape_output_t(const std::string &base)
+      : data_name(base + ".dat"), index_name(base + ".idx") {
+    open(data, data_name, shape_data_magic);
+    open(index, index_name, shape_index_magic);
+  }
+
+  void append(const shape_record_t &record,
+              const std::complex<double> *const hlm) {
+    const shape_index_t entry{record.horizon, record.iteration, record.time,
+                              std::int64_t(data.tellp())};
+    data.write(reinterpret_cast<const char *>(&record), sizeof record);
+    data.write(reinterpret_cast<const char *>(hlm),
+               record.ncoeffs * sizeof *hlm);
+    index.write(reinterpret_cast<const char *>(&entry), sizeof entry);
+    if (!data || !index)
+      CCTK_VERROR("Could not write horizon shape files \"%s\" and \"%s\"",
+                  data_name.c_str(), index_name.c_str());
+  }
+};
+
+} // namespace AHFinder
+
+#endif // #ifndef OUTPUT_HXX
@@ -1,15 +1,20 @@
 #ifndef SYLM_HXX
 #define SYLM_HXX
 
-// Implement a few spin-weighted spherical harmonics for testing
+// Spin-weighted spherical harmonics for testing and mode projections
 
 // #include <iostream>
 
+#include <cctk.h>
+
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <cmath>
 #include <complex>
+#include <cstdlib>
 #include <type_traits>
+#include <vector>
 
 namespace AHFinder {
 using namespace std;
@@ -20,7 +25,11 @@ using namespace std::complex_literals;
 // <https://www.black-holes.org/code/SpinWeightedSphericalHarmonics.nb>,
 // which is referenced by Wikipedia on
 // <https://en.wikipedia.org/wiki/Spin-weighted_spherical_harmonics>.
+//
+// There are closed forms for a few small values of (s, l), and a
+// recurrence that handles arbitrary (s, l, m).
 
+// Range of the closed forms
 constexpr int sYlm_smin = -1;
 constexpr int sYlm_smax = 1;
 constexpr int sYlm_lmax = 2;
@@ -266,8 +275,8 @@ dsYlm(const T theta, const T phi) {
 //
 
 template <typename T>
-constexpr complex<T> sYlm(const int s, const int l, const int m, const T theta,
-                          const T phi) {
+constexpr complex<T> sYlm_closed(const int s, const int l, const int m,
+                                 const T theta, const T phi) {
   if (s == -1 && l == 1 && m == -1)
     return sYlm<-1, 1, -1>(theta, phi);
   if (s == -1 && l == 1 && m == 0)
@@ -325,8 +334,9 @@ constexpr complex<T> sYlm(const int s, const int l, const int m, const T theta,
 }
 
 template <typename T>
-constexpr array<complex<T>, 2> dsYlm(const int s, const int l, const int m,
-                                     const T theta, const T phi) {
+constexpr array<complex<T>, 2> dsYlm_closed(const int s, const int l,
+                                            const int m, const T theta,
+                                            const T phi) {
   if (s == 0 && l == 0 && m == 0)
     return dsYlm<0, 0, 0>(theta, phi);
   if (s == 0 && l == 1 && m == -1)
@@ -349,6 +359,163 @@ constexpr array<complex<T>, 2> dsYlm(const int s, const int l, const int m,
   abort();
 }
 
+// Arbitrary (s, l, m)
+//
+// We use sY_lm(theta, phi) = (-1)^s sqrt((2l+1)/(4pi)) d^l_{m,-s}(theta)
+// exp(i m phi), which agrees with the closed forms above. The Wigner
+// d-functions d^l_{mm'} are evaluated with the three-term recurrence
+// in l,
+//
+//   l sqrt(((l+1)^2 - m^2) ((l+1)^2 - m'^2)) d^{l+1}_{mm'}
+//     = (2l+1) (l (l+1) cos theta - m m') d^l_{mm'}
+//       - (l+1) sqrt((l^2 - m^2) (l^2 - m'^2)) d^{l-1}_{mm'},
+//
+// starting from the closed form at l = max(|m|, |m'|). This is the
+// recurrence of the Jacobi polynomials, which is stable in the upward
+// direction, and which avoids the cancellations in the explicit sums
+// over factorials. The functions below handle a batch of angles at
+// once; their innermost loops run over the batch and vectorize.
+
+// d^l_{mm'}(theta_n) for one m, given x_n = cos theta_n, c_n = cos
+// theta_n/2, and s_n = sin theta_n/2. dm1 is workspace of the same
+// size as d.
+template <typename T>
+void wigner_d_m(const int l, const int m, const int mp, const int npoints,
+                const T *restrict const x, const T *restrict const c,
+                const T *restrict const s, T *restrict const d,
+                T *restrict const dm1) {
+  const int l0 = max(abs(m), abs(mp));
+  assert(l >= l0);
+
+  // At l = l0 only a single term of the explicit sum remains:
+  // d^l0_mm' = (-1)^max(m-m',0) sqrt(binomial(2 l0, l0 + n))
+  //            cos(theta/2)^(2 l0 - |m-m'|) sin(theta/2)^|m-m'|
+  // with n = m' if |m| = l0, else n = m
+  const int n0 = abs(abs(m) == l0 ? mp : m);
+  T binom = 1;
+  for (int k = 1; k <= l0 - n0; ++k)
+    binom *= T(l0 + n0 + k) / T(k);
+  const T coeff = T(bitsign(max(m - mp, 0))) * sqrt(binom);
+  const int ps = abs(m - mp);
+  const int pc = 2 * l0 - ps;
+#pragma omp simd
+  for (int n = 0; n < npoints; ++n) {
+    d[n] = coeff * pow(c[n], pc) * pow(s[n], ps);
+    dm1[n] = 0;
+  }
+
+  for (int ll = l0; ll < l; ++ll) {
+    if (ll == 0) {
+      // d^1_00 = cos theta; the recurrence is singular here
+#pragma omp simd
+      for (int n = 0; n < npoints; ++n) {
+        dm1[n] = d[n];
+        d[n] = x[n];
+      }
+      continue;
+    }
+    const T a = 1 / (ll * sqrt(T((ll + 1) * (ll + 1) - m * m) *
+                               T((ll + 1) * (ll + 1) - mp * mp)));
+    const T b = 2 * ll + 1;
+    const T bx = ll * (ll + 1);
+    const T bm = m * mp;
+    const T e = (ll + 1) * sqrt(T(ll * ll - m * m) * T(ll * ll - mp * mp));
+#pragma omp simd
+    for (int n = 0; n < npoints; ++n) {
+      const T dp1 = a * (b * (bx * x[n] - bm) * d[n] - e * dm1[n]);
+      dm1[n] = d[n];
+      d[n] = dp1;
+    }
+  }
+}
+
+// d^l_{mm'}(theta_n) for all m = -l ... l and a fixed m', at the angles
+// theta_n, n = 0 ... npoints-1, indexed as d[(m + l) * npoints + n]
+template <typename T>
+void wigner_d(const int l, const int mp, const int npoints,
+              const T *restrict const theta, T *restrict const d) {
+  assert(l >= 0 && abs(mp) <= l);
+  vector<T> x(npoints), c(npoints), s(npoints), dm1(npoints);
+#pragma omp simd
+  for (int n = 0; n < npoints; ++n) {
+    x[n] = cos(theta[n]);
+    c[n] = cos(theta[n] / 2);
+    s[n] = sin(theta[n] / 2);
+  }
+  for (int m = -l; m <= l; ++m)
+    wigner_d_m(l, m, mp, npoints, x.data(), c.data(), s.data(),
+               &d[(m + l) * npoints], dm1.data());
+}
+
+// sY_lm(theta_n, phi_n) for all m = -l ... l, indexed as
+// Y[(m + l) * npoints + n]
+template <typename T>
+void sYlm(const int s, const int l, const int npoints,
+          const T *restrict const theta, const T *restrict const phi,
+          complex<T> *restrict const Y) {
+  assert(l >= abs(s));
+  vector<T> d((2 * l + 1) * npoints);
+  wigner_d(l, -s, npoints, theta, d.data());
+  const T norm = bitsign(s) * sqrt((2 * l + 1) / (4 * T(M_PI)));
+  for (int m = -l; m <= l; ++m)
+#pragma omp simd
+    for (int n = 0; n < npoints; ++n)
+      Y[(m + l) * npoints + n] =
+          norm * d[(m + l) * npoints + n] * polar(T(1), m * phi[n]);
+}
+
+// Partial derivatives [\partial_theta, 1/\sin\theta \partial_\phi] of
+// 0Y_lm for all m = -l ... l, indexed as dY[(m + l) * npoints + n].
+// These follow from the spin-raised and -lowered harmonics,
+//   \partial_theta Y_lm = -1/2 sqrt(l (l+1)) (1Y_lm - -1Y_lm)
+//   1/\sin\theta \partial_\phi Y_lm = i/2 sqrt(l (l+1)) (1Y_lm + -1Y_lm)
+// which are regular at the poles.
+template <typename T>
+void dsYlm(const int s, const int l, const int npoints,
+           const T *restrict const theta, const T *restrict const phi,
+           array<complex<T>, 2> *restrict const dY) {
+  assert(s == 0);
+  assert(l >= 0);
+  if (l == 0) {
+    for (int n = 0; n < npoints; ++n)
+      dY[n] = {0, 0};
+    return;
+  }
+  vector<complex<T> > Yp((2 * l + 1) * npoints), Ym((2 * l + 1) * npoints);
+  sYlm(+1, l, npoints, theta, phi, Yp.data());
+  sYlm(-1, l, npoints, theta, phi, Ym.data());
+  const T f = sqrt(T(l * (l + 1))) / 2;
+  for (int mn = 0; mn < (2 * l + 1) * npoints; ++mn)
+    dY[mn] = {-f * (Yp[mn] - Ym[mn]), complex<T>(0, f) * (Yp[mn] + Ym[mn])};
+}
+
+// sY_lm(theta, phi) at a single point
+template <typename T>
+complex<T> sYlm(const int s, const int l, const int m, const T theta,
+                const T phi) {
+  assert(l >= abs(s) && abs(m) <= l);
+  const T x = cos(theta), c = cos(theta / 2), sn = sin(theta / 2);
+  T d, dm1;
+  wigner_d_m(l, m, -s, 1, &x, &c, &sn, &d, &dm1);
+  return T(bitsign(s)) * sqrt((2 * l + 1) / (4 * T(M_PI))) * d *
+         polar(T(1), m * phi);
+}
+
+// [\partial_theta, 1/\sin\theta \partial_\phi] of 0Y_lm at a single
+// point
+template <typename T>
+array<complex<T>, 2> dsYlm(const int s, const int l, const int m,
+                           const T theta, const T phi) {
+  assert(s == 0);
+  assert(l >= 0 && abs(m) <= l);
+  if (l == 0)
+    return {0, 0};
+  const complex<T> Yp = sYlm(+1, l, m, theta, phi);
+  const complex<T> Ym = sYlm(-1, l, m, theta, phi);
+  const T f = sqrt(T(l * (l + 1))) / 2;
+  return {-f * (Yp - Ym), complex<T>(0, f) * (Yp + Ym)};
+}
+
 } // namespace AHFinder
 
 #endif //#ifndef SYLM_HXX
@@ -0,0 +1,311 @@
+#ifndef SHT_HXX
+#define SHT_HXX
+
+#include "arena.hxx"
+
+#include <cctk.h>
+
+#include <ssht/ssht.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace AHFinder {
+
+// A range [imin, imax) of theta rows. Transforms that are restricted
+// to some rows read or write only the values on these rows. A forward
+// transform then yields the contribution of these rows to the
+// coefficients, and the sum of the contributions of all rows is the
+// full transform.
+struct rows_t {
+  int imin = 0;
+  int imax = std::numeric_limits<int>::max();
+
+  rows_t clamp(const int ntheta) const {
+    return {std::max(imin, 0), std::min(imax, ntheta)};
+  }
+};
+
+// Precomputed spin-weighted spherical harmonic transforms on the
+// McEwen-Wiaux grid.
+//
+// ssht recomputes the Wigner d-matrices in every call. All these
+// transforms are separable: they consist of a Fourier transform in phi
+// and, for each m, of a linear map between the values on the theta
+// grid and the coefficients l = max(|m|, |s|) ... lmax. We tabulate
+// these maps once per (nmodes, spin), obtaining them from ssht itself
+// by transforming unit impulses, so that the results agree with ssht
+// to round-off.
+class sht_plan_t {
+  using complex = std::complex<double>;
+
+  int nmodes, spin;
+  int ntheta, nphi, lmax, ncoeffs;
+
+  // exp(i m phi_j), indexed as [j * nphi + m + lmax]
+  std::vector<complex> expimphi;
+  // Synthesis, G_m(theta_i) = sum_l P_lm(theta_i) a_lm, indexed as
+  // [i * ncoeffs + cind(l, m)]
+  std::vector<complex> P;
+  // Analysis, a_lm = sum_i Q_lm(theta_i) F_m(theta_i), indexed as
+  // [i * ncoeffs + cind(l, m)]
+  std::vector<complex> Q;
+
+  static constexpr ssht_dl_method_t method = SSHT_DL_RISBO;
+  static constexpr int verbosity = 0; // [0..5]
+
+  int cind(const int l, const int m) const {
+    assert(l >= 0 && l <= lmax);
+    assert(m >= -l && m <= l);
+    return l * (l + 1) + m;
+  }
+  static constexpr int bitsign(const int i) { return i % 2 == 0 ? 1 : -1; }
+
+  // F_m(theta_i) = 1/nphi sum_j f(theta_i, phi_j) exp(-i m phi_j)
+  template <typename T, typename Vector>
+  void fourier_forward(Vector &F, const T *restrict const f,
+                       const int i, const int mmin) const {
+    for (int m = mmin; m <= lmax; ++m) {
+      complex s = 0;
+      for (int j = 0; j < nphi; ++j)
+        s += f[i * nphi + j] * conj(expimphi[j * nphi + m + lmax]);
+      F[m + lmax] = s / double(nphi);
+    }
+  }
+
+  struct cache_t {
+    struct entry_t {
+      std::shared_ptr<const sht_plan_t> plan;
+      std::uint64_t last_use = 0;
+    };
+    std::mutex mutex;
+    std::map<std::pair<int, int>, entry_t> plans;
+    std::uint64_t uses = 0;
+    std::size_t memory = 0;
+    std::size_t max_memory = std::numeric_limits<std::size_t>::max();
+
+    void evict() {
+      while (memory > max_memory && plans.size() > 1) {
+        auto oldest = plans.begin();
+        for (auto it = plans.begin(); it != plans.end(); ++it)
+          if (it->second.last_use < oldest->second.last_use)
+            oldest = it;
+        memory -= oldest->second.plan->memory();
+        plans.erase(oldest);
+      }
+    }
+  };
+  static cache_t &get_cache() {
+    static cache_t cache;
+    return cache;
+  }
+
+  sht_plan_t(const int nmodes, const int spin)
+      : nmodes(nmodes), spin(spin), ntheta(nmodes), nphi(2 * nmodes - 1),
+        lmax(nmodes - 1), ncoeffs(nmodes * nmodes),
+        expimphi(nphi * nphi), P(ntheta * ncoeffs, 0), Q(ntheta * ncoeffs, 0) {
+    assert(nmodes > 0);
+    assert(std::abs(spin) < nmodes);
+
+    for (int j = 0; j < nphi; ++j) {
+      const double phi = ssht_sampling_mw_p2phi(j, nmodes);
+      for (int m = -lmax; m <= lmax; ++m)
+        expimphi[j * nphi + m + lmax] = std::polar(1.0, m * phi);
+    }
+
+    std::vector<complex> flm(ncoeffs), f(ntheta * nphi), F(nphi);
+
+    // Synthesis: Evaluate all modes m of a given l at once, and
+    // separate them with a Fourier transform in phi
+    for (int l = std::abs(spin); l <= lmax; ++l) {
+      for (auto &a : flm)
+        a = 0;
+      for (int m = -l; m <= l; ++m)
+        flm[cind(l, m)] = 1;
+      ssht_core_mw_inverse_sov_sym(f.data(), flm.data(), nmodes, spin, method,
+                                   verbosity);
+      for (int i = 0; i < ntheta; ++i) {
+        fourier_forward(F, f.data(), i, -lmax);
+        for (int m = -l; m <= l; ++m)
+          P[i * ncoeffs + cind(l, m)] = F[m + lmax];
+      }
+    }
+
+    // Analysis: Expand a function that is nonzero only on the theta
+    // ring i, and whose Fourier modes there are F_m = 1 for all m
+    for (int i = 0; i < ntheta; ++i) {
+      for (auto &a : f)
+        a = 0;
+      for (int j = 0; j < nphi; ++j)
+        for (int m = -lmax; m <= lmax; ++m)
+          f[i * nphi + j] += expimphi[j * nphi + m + lmax];
+      ssht_core_mw_forward_sov_conv_sym(flm.data(), f.data(), nmodes, spin,
+                                        method, verbosity);
+      for (int l = std::abs(spin); l <= lmax; ++l)
+        for (int m = -l; m <= l; ++m)
+          Q[i * ncoeffs + cind(l, m)] = flm[cind(l, m)];
+    }
+  }
+
+public:
+  sht_plan_t() = delete;
+  sht_plan_t(const sht_plan_t &) = delete;
+  sht_plan_t &operator=(const sht_plan_t &) = delete;
+
+  // Memory used by the tables, O(nmodes^3)
+  std::size_t memory() const {
+    return sizeof(complex) * (expimphi.size() + P.size() + Q.size());
+  }
+
+  // Plans are created on first use and cached. When the cache exceeds
+  // its maximum memory, the least recently used plans are evicted;
+  // plans that are still in use remain valid until they are released.
+  static std::shared_ptr<const sht_plan_t> get(const int nmodes,
+                                               const int spin) {
+    cache_t &cache = get_cache();
+    const std::lock_guard<std::mutex> lock(cache.mutex);
+    auto &entry = cache.plans[{nmodes, spin}];
+    if (!entry.plan) {
+      entry.plan = std::shared_ptr<const sht_plan_t>(
+          new sht_plan_t(nmodes, spin));
+      cache.memory += entry.plan->memory();
+    }
+    entry.last_use = ++cache.uses;
+    const auto plan = entry.plan;
+    cache.evict();
+    return plan;
+  }
+
+  // Set the maximum memory of the cached plans. The plan used last is
+  // always kept, even if it alone exceeds this.
+  static void set_max_memory(const std::size_t max_memory) {
+    cache_t &cache = get_cache();
+    const std::lock_guard<std::mutex> lock(cache.mutex);
+    cache.max_memory = max_memory;
+    cache.evict();
+  }
+
+  // Free all cached plans
+  static void clear() {
+    cache_t &cache = get_cache();
+    const std::lock_guard<std::mutex> lock(cache.mutex);
+    cache.plans.clear();
+    cache.memory = 0;
+  }
+
+  // Equivalent to ssht_core_mw_forward_sov_conv_sym
+  void forward(complex *restrict const flm, const complex *restrict const f,
+               const rows_t &rows = {}) const {
+    const rows_t rs = rows.clamp(ntheta);
+    arena_vector<complex> F(nphi);
+    for (int n = 0; n < ncoeffs; ++n)
+      flm[n] = 0;
+    for (int i = rs.imin; i < rs.imax; ++i) {
+      fourier_forward(F, f, i, -lmax);
+      for (int l = std::abs(spin); l <= lmax; ++l)
+#pragma omp simd
+        for (int m = -l; m <= l; ++m)
+          flm[cind(l, m)] += Q[i * ncoeffs + cind(l, m)] * F[m + lmax];
+    }
+  }
+
+  // Equivalent to ssht_core_mw_inverse_sov_sym
+  void inverse(complex *restrict const f, const complex *restrict const flm,
+               const rows_t &rows = {}) const {
+    const rows_t rs = rows.clamp(ntheta);
+    arena_vector<complex> G(nphi);
+    for (int i = rs.imin; i < rs.imax; ++i) {
+      for (auto &g : G)
+        g = 0;
+      for (int l = std::abs(spin); l <= lmax; ++l)
+#pragma omp simd
+        for (int m = -l; m <= l; ++m)
+          G[m + lmax] += P[i * ncoeffs + cind(l, m)] * flm[cind(l, m)];
+      for (int j = 0; j < nphi; ++j) {
+        complex s = 0;
+        for (int m = -lmax; m <= lmax; ++m)
+          s += G[m + lmax] * expimphi[j * nphi + m + lmax];
+        f[i * nphi + j] = s;
+      }
+    }
+  }
+
+  // Equivalent to ssht_core_mw_forward_sov_conv_sym_real. The
+  // coefficients with m < 0 follow from f_l,-m = (-1)^m conj(f_lm).
+  void forward_real(complex *restrict const flm,
+                    const double *restrict const f,
+                    const rows_t &rows = {}) const {
+    assert(spin == 0);
+    const rows_t rs = rows.clamp(ntheta);
+    arena_vector<complex> F(nphi);
+    for (int n = 0; n < ncoeffs; ++n)
+      flm[n] = 0;
+    for (int i = rs.imin; i < rs.imax; ++i) {
+      fourier_forward(F, f, i, 0);
+      for (int l = 0; l <= lmax; ++l)
+#pragma omp simd
+        for (int m = 0; m <= l; ++m)
+          flm[cind(l, m)] += Q[i * ncoeffs + cind(l, m)] * F[m + lmax];
+    }
+    for (int l = 0; l <= lmax; ++l)
+      for (int m = 1; m <= l; ++m)
+        flm[cind(l, -m)] = double(bitsign(m)) * conj(flm[cind(l, m)]);
+  }
+
+  // Integral over the sphere, \int f dOmega = sqrt(4 pi) f_00. Only
+  // the coefficient l = m = 0 is needed, which makes this a quadrature
+  // with the weights sqrt(4 pi) Q_00(theta_i) / nphi.
+  double integrate(const double *restrict const f,
+                   const rows_t &rows = {}) const {
+    assert(spin == 0);
+    const rows_t rs = rows.clamp(ntheta);
+    double s = 0;
+    for (int i = rs.imin; i < rs.imax; ++i) {
+      double fi = 0;
+#pragma omp simd reduction(+ : fi)
+      for (int j = 0; j < nphi; ++j)
+        fi += f[i * nphi + j];
+      s += real(Q[i * ncoeffs + cind(0, 0)]) * fi;
+    }
+    return std::sqrt(4 * M_PI) * s / nphi;
+  }
+
+  // Equivalent to ssht_core_mw_inverse_sov_sym_real. Only the
+  // coefficients with m >= 0 are used.
+  void inverse_real(double *restrict const f,
+                    const complex *restrict const flm,
+                    const rows_t &rows = {}) const {
+    assert(spin == 0);
+    const rows_t rs = rows.clamp(ntheta);
+    arena_vector<complex> G(nphi);
+    for (int i = rs.imin; i < rs.imax; ++i) {
+      for (auto &g : G)
+        g = 0;
+      for (int l = 0; l <= lmax; ++l)
+#pragma omp simd
+        for (int m = 0; m <= l; ++m)
+          G[m + lmax] += P[i * ncoeffs + cind(l, m)] * flm[cind(l, m)];
+      // G_-m = conj(G_m) for real functions
+      for (int j = 0; j < nphi; ++j) {
+        double s = real(G[lmax]);
+        for (int m = 1; m <= lmax; ++m)
+          s += 2 * real(G[m + lmax] * expimphi[j * nphi + m + lmax]);
+        f[i * nphi + j] = s;
+      }
+    }
+  }
+};
+
+} // namespace AHFinder
+
+#endif // #ifndef SHT_HXX
@@ -5,6 +5,7 @@
 #include <cctk_Arguments.h>
 
 #include <algorithm>
+#include <array>
 #include <cassert>
 #include <cmath>
 #include <complex>
@@ -60,24 +61,22 @@ template <typename T> void test_aij_alm() {
         // const aij_t<std::complex<T> > aij = evaluate(alm, 0);
 
         // Check
-        if (ll <= sYlm_lmax) {
-          for (int i = 0; i < geom.ntheta; ++i) {
-            for (int j = 0; j < geom.nphi; ++j) {
-              const T theta = geom.coord_theta(i, j);
-              const T phi = geom.coord_phi(i, j);
-              const T a = aij(i, j);
-              std::complex<T> sc;
-              if (mm == 0) {
-                sc = sYlm(0, ll, mm, theta, phi);
-              } else {
-                const std::complex<T> c = cc == 0 ? 1.0 : 1.0i;
-                sc = c * sYlm(0, ll, mm, theta, phi) +
-                     T(bitsign(mm)) * conj(c) * sYlm(0, ll, -mm, theta, phi);
-              }
-              assert(isapprox(imag(sc), T(0)));
-              const T s = real(sc);
-              assert(isapprox(a, s));
+        for (int i = 0; i < geom.ntheta; ++i) {
+          for (int j = 0; j < geom.nphi; ++j) {
+            const T theta = geom.coord_theta(i, j);
+            const T phi = geom.coord_phi(i, j);
+            const T a = aij(i, j);
+            std::complex<T> sc;
+            if (mm == 0) {
+              sc = sYlm(0, ll, mm, theta, phi);
+            } else {
+              const std::complex<T> c = cc == 0 ? 1.0 : 1.0i;
+              sc = c * sYlm(0, ll, mm, theta, phi) +
+                   T(bitsign(mm)) * conj(c) * sYlm(0, ll, -mm, theta, phi);
             }
+            assert(isapprox(imag(sc), T(0)));
+            const T s = real(sc);
+            assert(isapprox(a, s));
           }
         }
 
@@ -106,34 +105,32 @@ template <typename T> void test_aij_alm() {
         const aij_t<std::complex<T> > daij = evaluate_grad(dalm);
 
         // Check
-        if (ll <= sYlm_lmax) {
-          for (int i = 0; i < geom.ntheta; ++i) {
-            for (int j = 0; j < geom.nphi; ++j) {
-              const T theta = geom.coord_theta(i, j);
-              const T phi = geom.coord_phi(i, j);
-              const std::complex<T> da = daij(i, j);
-              array<std::complex<T>, 2> dsc;
-              if (mm == 0) {
-                dsc = dsYlm(0, ll, mm, theta, phi);
-              } else {
-                const std::complex<T> c = cc == 0 ? 1.0 : 1.0i;
-                const array<std::complex<T>, 2> dsc_p =
-                    dsYlm(0, ll, mm, theta, phi);
-                const array<std::complex<T>, 2> dsc_m =
-                    dsYlm(0, ll, -mm, theta, phi);
-                for (int n = 0; n < 2; ++n) {
-                  dsc[n] = c * dsc_p[n] + T(bitsign(mm)) * conj(c) * dsc_m[n];
-                  assert(isapprox(imag(dsc[n]), T(0)));
-                }
+        for (int i = 0; i < geom.ntheta; ++i) {
+          for (int j = 0; j < geom.nphi; ++j) {
+            const T theta = geom.coord_theta(i, j);
+            const T phi = geom.coord_phi(i, j);
+            const std::complex<T> da = daij(i, j);
+            array<std::complex<T>, 2> dsc;
+            if (mm == 0) {
+              dsc = dsYlm(0, ll, mm, theta, phi);
+            } else {
+              const std::complex<T> c = cc == 0 ? 1.0 : 1.0i;
+              const array<std::complex<T>, 2> dsc_p =
+                  dsYlm(0, ll, mm, theta, phi);
+              const array<std::complex<T>, 2> dsc_m =
+                  dsYlm(0, ll, -mm, theta, phi);
+              for (int n = 0; n < 2; ++n) {
+                dsc[n] = c * dsc_p[n] + T(bitsign(mm)) * conj(c) * dsc_m[n];
+                assert(isapprox(imag(dsc[n]), T(0)));
               }
-              std::complex<T> ds{real(dsc[0]), real(dsc[1])};
-              if (!(isapprox(da, ds)))
-                CCTK_VINFO("ll=%d,mm=%d,cc=%d i=%d,j=%d,theta=%f,phi=%f "
-                           "da=(%f,%f) ds=(%f,%f)",
-                           ll, mm, cc, i, j, theta, phi, real(da), imag(da),
-                           real(ds), imag(ds));
-              assert(isapprox(da, ds));
             }
+            std::complex<T> ds{real(dsc[0]), real(dsc[1])};
+            if (!(isapprox(da, ds)))
+              CCTK_VINFO("ll=%d,mm=%d,cc=%d i=%d,j=%d,theta=%f,phi=%f "
+                         "da=(%f,%f) ds=(%f,%f)",
+                         ll, mm, cc, i, j, theta, phi, real(da), imag(da),
+                         real(ds), imag(ds));
+            assert(isapprox(da, ds));
           }
         }
 
@@ -239,6 +236,18 @@ template <typename T> void test_scalar_aij_alm() {
     scalar_aij_t<T> xij2 = evaluate(x2);
     scalar_alm_t<std::complex<T> > x3 = expand(xij2);
     assert(isapproxv(x3, x2));
+
+    // Prolongation followed by restriction is the identity, and
+    // prolongation does not change the function
+    const geom_t fine_geom(2 * nmodes);
+    const scalar_alm_t<std::complex<T> > xf = resample(x2, fine_geom);
+    assert(isapproxv(resample(xf, geom), x2));
+    assert(isapprox(average(xf), average(x2)));
+    // Both grids contain the south pole
+    const scalar_aij_t<T> xfij = evaluate(xf);
+    for (int j = 0; j < fine_geom.nphi; ++j)
+      assert(isapprox(xfij()(fine_geom.ntheta - 1, j),
+                      xij2()(geom.ntheta - 1, 0)));
   }
 }
 
@@ -523,6 +532,82 @@ template <typename T> void test_scalar_gradient() {
   }
 }
 
+template <typename T> void test_integrate() {
+  CCTK_VINFO("test_integrate...");
+
+  for (int nmodes = 3; nmodes <= 9; nmodes += 2) {
+    const geom_t geom(nmodes);
+
+    scalar_aij_t<T> oneij(geom), cos2ij(geom), Yij(geom);
+    for (int i = 0; i < geom.ntheta; ++i) {
+      for (int j = 0; j < geom.nphi; ++j) {
+        const T theta = geom.coord_theta(i, j);
+        const T phi = geom.coord_phi(i, j);
+        using std::cos, std::sin;
+        oneij()(i, j) = 1;
+        cos2ij()(i, j) = cos(theta) * cos(theta);
+        Yij()(i, j) = sin(theta) * cos(theta) * cos(phi);
+      }
+    }
+
+    assert(isapprox(integrate(oneij), 4 * T(M_PI)));
+    assert(isapprox(integrate(cos2ij), 4 * T(M_PI) / 3));
+    assert(isapprox(integrate(Yij), 0));
+  }
+}
+
+template <typename T> void test_rows() {
+  CCTK_VINFO("test_rows...");
+
+  const int nmodes = 9;
+  const geom_t geom(nmodes);
+
+  std::mt19937 engine(42);
+  std::uniform_real_distribution<T> dist(-1, 1);
+  scalar_aij_t<T> fij(geom);
+  vector_aij_t<T> vij(geom);
+  for (int i = 0; i < geom.ntheta; ++i) {
+    for (int j = 0; j < geom.nphi; ++j) {
+      fij()(i, j) = dist(engine);
+      vij(0)(i, j) = dist(engine);
+      vij(1)(i, j) = dist(engine);
+    }
+  }
+  const auto flm = expand(fij);
+  const auto vlm = expand(vij);
+  const auto fij1 = evaluate(flm);
+  const auto vij1 = evaluate(vlm);
+
+  // Split the rows unevenly; the contributions add up to the full
+  // transform, and the values on each part agree with the full
+  // evaluation
+  const std::array<rows_t, 3> parts{
+      rows_t{0, 2}, rows_t{2, 3}, rows_t{3, geom.ntheta}};
+  scalar_alm_t<std::complex<T> > flm_sum(geom);
+  vector_alm_t<std::complex<T> > vlm_sum(geom);
+  flm_sum = std::complex<T>(0);
+  vlm_sum = std::complex<T>(0);
+  T integral_sum = 0;
+  for (const auto &rows : parts) {
+    flm_sum += expand(fij, rows);
+    vlm_sum += expand(vij, rows);
+    integral_sum += integrate(fij, rows);
+
+    const auto fij2 = evaluate(flm, rows);
+    const auto vij2 = evaluate(vlm, rows);
+    for (int i = rows.imin; i < rows.imax; ++i) {
+      for (int j = 0; j < geom.nphi; ++j) {
+        assert(isapprox(fij2()(i, j), fij1()(i, j)));
+        assert(isapprox(vij2(0)(i, j), vij1(0)(i, j)));
+        assert(isapprox(vij2(1)(i, j), vij1(1)(i, j)));
+      }
+    }
+  }
+  assert(isapproxv(flm_sum, flm));
+  assert(isapproxv(vlm_sum, vlm));
+  assert(isapprox(integral_sum, integrate(fij)));
+}
+
 extern "C" void AHFinder_test_discretization(CCTK_ARGUMENTS) {
   DECLARE_CCTK_ARGUMENTS_AHFinder_test_discretization;
 
@@ -533,6 +618,8 @@ extern "C" void AHFinder_test_discretization(CCTK_ARGUMENTS) {
   test_tensor_aij_alm<CCTK_REAL>();
   test_tensor3_aij_alm<CCTK_REAL>();
   test_scalar_gradient<CCTK_REAL>();
+  test_integrate<CCTK_REAL>();
+  test_rows<CCTK_REAL>();
   CCTK_VINFO("Done.");
 }
 
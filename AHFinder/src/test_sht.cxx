@@ -1,3 +1,4 @@
+#include "sht.hxx"
 #include "sYlm.hxx"
 
 #include <ssht/ssht.h>
@@ -6,10 +7,12 @@
 #include <cctk_Arguments.h>
 
 #include <algorithm>
+#include <array>
 #include <cassert>
 #include <cmath>
 #include <complex>
 #include <cstdint>
+#include <random>
 #include <vector>
 
 namespace AHFinder {
@@ -68,8 +71,8 @@ extern "C" void AHFinder_test_sht(CCTK_ARGUMENTS) {
 
   // Test complex spherical harmonic functions
 
-  for (int spin = sYlm_smin; spin <= sYlm_smax; ++spin) {
-    for (int ll = abs(spin); ll <= sYlm_lmax; ++ll) {
+  for (int spin = -2; spin <= 2; ++spin) {
+    for (int ll = abs(spin); ll <= lmax; ++ll) {
       for (int mm = -ll; mm <= ll; ++mm) {
 
         // Choose function
@@ -145,7 +148,7 @@ extern "C" void AHFinder_test_sht(CCTK_ARGUMENTS) {
 
   {
     const int spin = 0;
-    for (int ll = abs(spin); ll <= sYlm_lmax; ++ll) {
+    for (int ll = abs(spin); ll <= lmax; ++ll) {
       for (int mm = -ll; mm <= ll; ++mm) {
 
         vector<complex<double> > alm(ncoeffs, complex<double>{NAN, NAN});
@@ -208,7 +211,7 @@ extern "C" void AHFinder_test_sht(CCTK_ARGUMENTS) {
   // Test gradient of real spherical harmonic functions
 
   for (const int spin : {-1, 1}) {
-    for (int ll = abs(spin); ll <= sYlm_lmax; ++ll) {
+    for (int ll = abs(spin); ll <= lmax; ++ll) {
       for (int mm = -ll; mm <= ll; ++mm) {
 
         for (int i = 0; i < ntheta; ++i) {
@@ -233,6 +236,122 @@ extern "C" void AHFinder_test_sht(CCTK_ARGUMENTS) {
       }
     }
   }
+
+  // Test cached transform plans against ssht
+
+  mt19937 engine(42);
+  uniform_real_distribution<double> dist(-1, 1);
+  const auto randc = [&]() {
+    return complex<double>(dist(engine), dist(engine));
+  };
+
+  for (const int nm : {5, 9}) {
+    const int np = nm * (2 * nm - 1);
+    const int nc = nm * nm;
+    for (int spin = -3; spin <= 3; ++spin) {
+      const auto plan = sht_plan_t::get(nm, spin);
+
+      vector<complex<double> > alm(nc, 0);
+      for (int l = abs(spin); l < nm; ++l)
+        for (int m = -l; m <= l; ++m)
+          alm.at(l * (l + 1) + m) = randc();
+
+      vector<complex<double> > aij(np), bij(np);
+      ssht_core_mw_inverse_sov_sym(aij.data(), alm.data(), nm, spin, method,
+                                   verbosity);
+      plan->inverse(bij.data(), alm.data());
+      for (int n = 0; n < np; ++n)
+        assert(abs(bij.at(n) - aij.at(n)) <= 1.0e-12);
+
+      vector<complex<double> > blm(nc);
+      plan->forward(blm.data(), aij.data());
+      for (int n = 0; n < nc; ++n)
+        assert(abs(blm.at(n) - alm.at(n)) <= 1.0e-12);
+
+      if (spin == 0) {
+        // f_l,-m = (-1)^m conj(f_lm)
+        for (int l = 0; l < nm; ++l) {
+          alm.at(l * (l + 1)) = real(alm.at(l * (l + 1)));
+          for (int m = 1; m <= l; ++m)
+            alm.at(l * (l + 1) - m) =
+                double(bitsign(m)) * conj(alm.at(l * (l + 1) + m));
+        }
+
+        vector<double> rij(np), sij(np);
+        ssht_core_mw_inverse_sov_sym_real(rij.data(), alm.data(), nm, method,
+                                          verbosity);
+        plan->inverse_real(sij.data(), alm.data());
+        for (int n = 0; n < np; ++n)
+          assert(abs(sij.at(n) - rij.at(n)) <= 1.0e-12);
+
+        plan->forward_real(blm.data(), rij.data());
+        for (int n = 0; n < nc; ++n)
+          assert(abs(blm.at(n) - alm.at(n)) <= 1.0e-12);
+      }
+    }
+  }
+
+  // Test the recurrence against the closed forms
+
+  uniform_real_distribution<double> theta_dist(0, M_PI);
+  uniform_real_distribution<double> phi_dist(0, 2 * M_PI);
+  const int nrandom = 17;
+  vector<double> thetas(nrandom), phis(nrandom);
+  for (int n = 0; n < nrandom; ++n) {
+    thetas.at(n) = theta_dist(engine);
+    phis.at(n) = phi_dist(engine);
+  }
+  // Include the poles
+  thetas.at(0) = 0;
+  thetas.at(1) = M_PI;
+
+  for (int spin = sYlm_smin; spin <= sYlm_smax; ++spin) {
+    for (int ll = abs(spin); ll <= sYlm_lmax; ++ll) {
+      vector<complex<double> > Y((2 * ll + 1) * nrandom);
+      sYlm(spin, ll, nrandom, thetas.data(), phis.data(), Y.data());
+      vector<array<complex<double>, 2> > dY((2 * ll + 1) * nrandom);
+      if (spin == 0)
+        dsYlm(spin, ll, nrandom, thetas.data(), phis.data(), dY.data());
+      for (int mm = -ll; mm <= ll; ++mm) {
+        for (int n = 0; n < nrandom; ++n) {
+          const double theta = thetas.at(n);
+          const double phi = phis.at(n);
+          const complex<double> s = sYlm_closed(spin, ll, mm, theta, phi);
+          assert(abs(sYlm(spin, ll, mm, theta, phi) - s) <= 1.0e-12);
+          assert(abs(Y.at((mm + ll) * nrandom + n) - s) <= 1.0e-12);
+          if (spin == 0) {
+            const array<complex<double>, 2> ds =
+                dsYlm_closed(spin, ll, mm, theta, phi);
+            const array<complex<double>, 2> ds1 =
+                dsYlm(spin, ll, mm, theta, phi);
+            const array<complex<double>, 2> ds2 =
+                dY.at((mm + ll) * nrandom + n);
+            for (int d = 0; d < 2; ++d) {
+              assert(abs(ds1[d] - ds[d]) <= 1.0e-12);
+              assert(abs(ds2[d] - ds[d]) <= 1.0e-12);
+            }
+          }
+        }
+      }
+    }
+  }
+
+  // Test high l with the addition theorem, sum_m |sY_lm|^2 =
+  // (2l+1)/(4pi)
+
+  for (const int spin : {-2, 0, 1}) {
+    for (const int ll : {10, 50, 200}) {
+      vector<complex<double> > Y((2 * ll + 1) * nrandom);
+      sYlm(spin, ll, nrandom, thetas.data(), phis.data(), Y.data());
+      for (int n = 0; n < nrandom; ++n) {
+        double sum = 0;
+        for (int mm = -ll; mm <= ll; ++mm)
+          sum += norm(Y.at((mm + ll) * nrandom + n));
+        assert(abs(sum - (2 * ll + 1) / (4 * M_PI)) <=
+               1.0e-12 * (2 * ll + 1));
+      }
+    }
+  }
 }
 
 } // namespace AHFinder
@@ -0,0 +1,124 @@
+#ifndef TIMERS_HXX
+#define TIMERS_HXX
+
+#include <array>
+#include <chrono>
+#include <utility>
+
+namespace AHFinder {
+
+// Wall-clock time spent in the stages of a find, for benchmarking.
+// Stages are only timed while a stage_times_scope_t exists on the
+// calling thread; otherwise the timers do nothing.
+//
+// Stage timers may nest. Each stage is charged only for the time in
+// which it is the innermost running stage, so that the times of all
+// stages add up to the time spent in any of them.
+enum class stage_t {
+  evaluate,    // inverse transforms, h_lm -> h(theta, phi)
+  gradient,    // derivatives in coefficient space
+  coordinates, // Cartesian coordinates of the surface points
+  metric,      // evaluating or interpolating the metric
+  expansion,   // pointwise expansion and quasi-local integrands
+  transform,   // forward transforms and quadratures
+  step,        // solver update (fast flow step, GMRES)
+};
+constexpr int nstages = 7;
+constexpr std::array<const char *, nstages> stage_names{
+    "evaluate", "gradient",  "coordinates", "metric",
+    "expansion", "transform", "step",
+};
+
+class stage_times_t {
+  using clock = std::chrono::steady_clock;
+
+  int active = -1;
+  clock::time_point since;
+
+  static stage_times_t *&current_ref() {
+    static thread_local stage_times_t *current = nullptr;
+    return current;
+  }
+
+public:
+  std::array<double, nstages> seconds{};
+  std::array<long, nstages> calls{};
+
+  // The times of the innermost active scope on this thread, if any
+  static stage_times_t *current() { return current_ref(); }
+
+  // Charge the time since the last switch to the active stage, and
+  // make another stage (or none, if negative) active. Returns the
+  // previously active stage.
+  int switch_to(const int stage) {
+    const clock::time_point now = clock::now();
+    if (active >= 0)
+      seconds[active] += std::chrono::duration<double>(now - since).count();
+    since = now;
+    return std::exchange(active, stage);
+  }
+
+  double total() const {
+    double t = 0;
+    for (const double s : seconds)
+      t += s;
+    return t;
+  }
+
+  friend class stage_times_scope_t;
+};
+
+// Activate timing on this thread for the lifetime of this object
+class stage_times_scope_t {
+  stage_times_t *const previous;
+
+public:
+  stage_times_scope_t(stage_times_t &times)
+      : previous(stage_times_t::current_ref()) {
+    stage_times_t::current_ref() = &times;
+  }
+  stage_times_scope_t(const stage_times_scope_t &) = delete;
+  stage_times_scope_t &operator=(const stage_times_scope_t &) = delete;
+  ~stage_times_scope_t() { stage_times_t::current_ref() = previous; }
+};
+
+// Time a stage from construction until stop() or destruction
+class stage_timer_t {
+  stage_times_t *const times;
+  const int stage;
+  int previous = -1;
+  bool running = false;
+
+public:
+  explicit stage_timer_t(const stage_t stage)
+      : times(stage_times_t::current()), stage(int(stage)) {
+    start();
+  }
+  stage_timer_t(const stage_timer_t &) = delete;
+  stage_timer_t &operator=(const stage_timer_t &) = delete;
+  ~stage_timer_t() { stop(); }
+
+  void start() {
+    if (!times || running)
+      return;
+    previous = times->switch_to(stage);
+    ++times->calls[stage];
+    running = true;
+  }
+  void stop() {
+    if (!times || !running)
+      return;
+    times->switch_to(previous);
+    running = false;
+  }
+};
+
+// Evaluate f() as a stage
+template <typename F> auto timed(const stage_t stage, F &&f) {
+  const stage_timer_t timer(stage);
+  return std::forward<F>(f)();
+}
+
+} // namespace AHFinder
+
+#endif // #ifndef TIMERS_HXX
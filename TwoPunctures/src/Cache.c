@@ -0,0 +1,428 @@
+/* TwoPunctures:  File  "Cache.c"*/
+
+/* On-disk cache of converged spectral solutions.
+
+   Every solution is stored in its own file <dir>/TwoPunctures-<hash>.dat,
+   where <hash> is a hash of all parameters that determine the solution.
+   The file consists of a cache_header, followed by the ntotal values of
+   v.d0 and of cf_v.d0, as they are laid out in memory (native byte
+   order). All parts are multiples of 8 bytes long, so that the file can
+   be memory-mapped and its arrays used in place.
+
+   A run whose parameters hash to an existing file reads the solution
+   instead of solving. Otherwise, the solution of the closest cached
+   parameters (with the same resolution) can serve as initial guess.
+   Only process 0 looks into the cache, in TwoPunctures_CacheLookup, and
+   broadcasts what it found, so that all processes use the same data
+   even while other runs add files. */
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <mpi.h>
+#include "cctk.h"
+#include "cctk_Arguments.h"
+#include "cctk_Parameters.h"
+#include "TP_utilities.h"
+#include "TwoPunctures.h"
+
+/* The parameters that determine the solution. When the bare masses
+   are found from target ADM masses, the bare masses given in the
+   parameter file are only an initial guess and are not part of the
+   key. */
+typedef struct CACHE_KEY {
+  double par_b;
+  double mass[2];  /* bare masses, or target ADM masses */
+  double adm_tol;  /* 0 when the bare masses are given */
+  double P_plus[3], P_minus[3], S_plus[3], S_minus[3];
+  double TP_epsilon, TP_Tiny, Newton_tol;
+  int32_t give_bare_mass, Newton_maxit;
+  int32_t nvar, n1, n2, n3;
+} cache_key;
+
+typedef struct CACHE_HEADER {
+  char magic[8];
+  cache_key key;
+  double mp, mm, mp_adm, mm_adm, E; /* bare, puncture ADM and total ADM
+                                       masses of the solution */
+} cache_header;
+
+static const char cache_magic[8] = {'T', 'P', 'S', 'O', 'L', 'N', '0', '1'};
+
+typedef char cache_key_is_padded[sizeof(cache_key) % 8 == 0 ? 1 : -1];
+typedef char cache_header_is_padded[sizeof(cache_header) % 8 == 0 ? 1 : -1];
+
+/* A cache file mapped into memory */
+typedef struct CACHE_FILE {
+  void *map;
+  size_t size;
+  const cache_header *header;
+  const CCTK_REAL *v, *cf_v;
+} cache_file;
+
+/* -------------------------------------------------------------------*/
+static void make_key(cache_key *key, int nvar, int n1, int n2, int n3) {
+  DECLARE_CCTK_PARAMETERS;
+
+  /* Clear the padding as well, since the key is hashed as bytes */
+  memset(key, 0, sizeof *key);
+  key->par_b = par_b;
+  key->give_bare_mass = give_bare_mass;
+  if (give_bare_mass) {
+    key->mass[0] = par_m_plus;
+    key->mass[1] = par_m_minus;
+  } else {
+    key->mass[0] = target_M_plus;
+    key->mass[1] = target_M_minus;
+    key->adm_tol = adm_tol;
+  }
+  for (int d = 0; d < 3; d++) {
+    key->P_plus[d] = par_P_plus[d];
+    key->P_minus[d] = par_P_minus[d];
+    key->S_plus[d] = par_S_plus[d];
+    key->S_minus[d] = par_S_minus[d];
+  }
+  key->TP_epsilon = TP_epsilon;
+  key->TP_Tiny = TP_Tiny;
+  key->Newton_tol = Newton_tol;
+  key->Newton_maxit = Newton_maxit;
+  key->nvar = nvar;
+  key->n1 = n1;
+  key->n2 = n2;
+  key->n3 = n3;
+}
+
+/* -------------------------------------------------------------------*/
+/* 64-bit FNV-1a hash */
+static uint64_t hash_key(const cache_key *key) {
+  const unsigned char *p = (const unsigned char *)key;
+  uint64_t h = UINT64_C(14695981039346656037);
+  for (size_t i = 0; i < sizeof *key; i++) {
+    h ^= p[i];
+    h *= UINT64_C(1099511628211);
+  }
+  return h;
+}
+
+/* -------------------------------------------------------------------*/
+/* Distance between two parameter sets of the same kind */
+static double key_distance(const cache_key *a, const cache_key *b) {
+  double d2 = pow(a->par_b - b->par_b, 2) + pow(a->mass[0] - b->mass[0], 2) +
+              pow(a->mass[1] - b->mass[1], 2);
+  for (int d = 0; d < 3; d++)
+    d2 += pow(a->P_plus[d] - b->P_plus[d], 2) +
+          pow(a->P_minus[d] - b->P_minus[d], 2) +
+          pow(a->S_plus[d] - b->S_plus[d], 2) +
+          pow(a->S_minus[d] - b->S_minus[d], 2);
+  return sqrt(d2);
+}
+
+/* -------------------------------------------------------------------*/
+static const char *cache_dir(void) {
+  DECLARE_CCTK_PARAMETERS;
+  return *solution_cache_dir ? solution_cache_dir : out_dir;
+}
+
+/* -------------------------------------------------------------------*/
+/* Map a cache file; returns 0 if it is not a valid cache file */
+static int open_cache_file(cache_file *file, const char *name) {
+  struct stat st;
+  int fd = open(name, O_RDONLY);
+
+  memset(file, 0, sizeof *file);
+  if (fd < 0)
+    return 0;
+  if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(cache_header)) {
+    close(fd);
+    return 0;
+  }
+  file->size = st.st_size;
+  file->map = mmap(NULL, file->size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (file->map == MAP_FAILED) {
+    file->map = NULL;
+    return 0;
+  }
+
+  file->header = file->map;
+  const cache_key *key = &file->header->key;
+  size_t const ntotal = (size_t)key->nvar * key->n1 * key->n2 * key->n3;
+  if (memcmp(file->header->magic, cache_magic, sizeof cache_magic) != 0 ||
+      file->size != sizeof(cache_header) + 2 * ntotal * sizeof(CCTK_REAL)) {
+    munmap(file->map, file->size);
+    file->map = NULL;
+    return 0;
+  }
+  file->v = (const CCTK_REAL *)(file->header + 1);
+  file->cf_v = file->v + ntotal;
+  return 1;
+}
+
+/* -------------------------------------------------------------------*/
+static void close_cache_file(cache_file *file) {
+  if (file->map)
+    munmap(file->map, file->size);
+  file->map = NULL;
+}
+
+/* -------------------------------------------------------------------*/
+/* Set the bare masses after they have been found elsewhere */
+static void set_bare_masses(CCTK_REAL mp, CCTK_REAL mm) {
+  char valbuf[100];
+
+  sprintf(valbuf, "%.17g", (double)mp);
+  CCTK_ParameterSet("par_m_plus", "TwoPunctures", valbuf);
+  sprintf(valbuf, "%.17g", (double)mm);
+  CCTK_ParameterSet("par_m_minus", "TwoPunctures", valbuf);
+}
+
+/* -------------------------------------------------------------------*/
+/* Read the solution for the current parameters into v and cf_v. Returns
+   1 if it was found, and sets the bare masses mp and mm. */
+static int read_solution(int nvar, int n1, int n2, int n3, CCTK_REAL *v,
+                         CCTK_REAL *cf_v, CCTK_REAL *mp, CCTK_REAL *mm) {
+  int const ntotal = nvar * n1 * n2 * n3;
+  cache_key key;
+  cache_file file;
+  char name[1000];
+
+  make_key(&key, nvar, n1, n2, n3);
+  snprintf(name, sizeof name, "%s/TwoPunctures-%016llx.dat", cache_dir(),
+           (unsigned long long)hash_key(&key));
+  if (!open_cache_file(&file, name))
+    return 0;
+  if (memcmp(&file.header->key, &key, sizeof key) != 0) {
+    CCTK_VWARN(CCTK_WARN_ALERT,
+               "Ignoring cached solution \"%s\" for different parameters",
+               name);
+    close_cache_file(&file);
+    return 0;
+  }
+
+  memcpy(v, file.v, ntotal * sizeof *v);
+  memcpy(cf_v, file.cf_v, ntotal * sizeof *cf_v);
+  *mp = file.header->mp;
+  *mm = file.header->mm;
+  CCTK_VINFO("Read cached solution \"%s\"", name);
+  close_cache_file(&file);
+  return 1;
+}
+
+/* -------------------------------------------------------------------*/
+/* Read the cached solution with the closest parameters (and the same
+   resolution) into v, and its bare masses into mp and mm. Returns 1 if
+   such a solution was found. */
+static int guess_solution(int nvar, int n1, int n2, int n3, CCTK_REAL *v,
+                          CCTK_REAL *mp, CCTK_REAL *mm) {
+  DECLARE_CCTK_PARAMETERS;
+  int const ntotal = nvar * n1 * n2 * n3;
+  cache_key key;
+  char best_name[1000] = "", name[1000];
+  double best_distance = solution_cache_guess_distance;
+  DIR *dir;
+  struct dirent *entry;
+
+  if (solution_cache_guess_distance <= 0)
+    return 0;
+  dir = opendir(cache_dir());
+  if (!dir)
+    return 0;
+
+  make_key(&key, nvar, n1, n2, n3);
+  while ((entry = readdir(dir))) {
+    size_t const len = strlen(entry->d_name);
+    cache_file file;
+    if (strncmp(entry->d_name, "TwoPunctures-", 13) != 0 || len < 4 ||
+        strcmp(entry->d_name + len - 4, ".dat") != 0)
+      continue;
+    snprintf(name, sizeof name, "%s/%s", cache_dir(), entry->d_name);
+    if (!open_cache_file(&file, name))
+      continue;
+    const cache_key *other = &file.header->key;
+    if (other->give_bare_mass == key.give_bare_mass &&
+        other->nvar == key.nvar && other->n1 == key.n1 &&
+        other->n2 == key.n2 && other->n3 == key.n3) {
+      double const distance = key_distance(&key, other);
+      if (distance <= best_distance) {
+        best_distance = distance;
+        strcpy(best_name, name);
+      }
+    }
+    close_cache_file(&file);
+  }
+  closedir(dir);
+
+  cache_file file;
+  if (!*best_name || !open_cache_file(&file, best_name))
+    return 0;
+  memcpy(v, file.v, ntotal * sizeof *v);
+  *mp = file.header->mp;
+  *mm = file.header->mm;
+  CCTK_VINFO("Using cached solution \"%s\" at parameter distance %g as "
+             "initial guess",
+             best_name, best_distance);
+  close_cache_file(&file);
+  return 1;
+}
+
+/* -------------------------------------------------------------------*/
+/* The result of the lookup, as broadcast from process 0 */
+static struct CACHE_LOOKUP {
+  enum { LOOKUP_NONE, LOOKUP_SOLUTION, LOOKUP_GUESS } found;
+  int ntotal;
+  CCTK_REAL *v, *cf_v;
+  CCTK_REAL mp, mm;
+} lookup = {LOOKUP_NONE, 0, NULL, NULL, 0, 0};
+
+static void free_lookup(void) {
+  free(lookup.v);
+  free(lookup.cf_v);
+  lookup.found = LOOKUP_NONE;
+  lookup.v = lookup.cf_v = NULL;
+}
+
+/* Look for the solution for the current parameters, or else for an
+   initial guess, on process 0 and broadcast the result. If the bare
+   masses are not given, set the parameters par_m_plus and par_m_minus
+   from it. Scheduled in global mode, before TwoPunctures. */
+void TwoPunctures_CacheLookup(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTS_TwoPunctures_CacheLookup;
+  DECLARE_CCTK_PARAMETERS;
+  int const nvar = 1, n1 = npoints_A, n2 = npoints_B, n3 = npoints_phi;
+  int const ntotal = nvar * n1 * n2 * n3;
+  int found = LOOKUP_NONE;
+  CCTK_REAL masses[2];
+
+  free_lookup();
+  lookup.ntotal = ntotal;
+  lookup.v = malloc(ntotal * sizeof *lookup.v);
+  lookup.cf_v = malloc(ntotal * sizeof *lookup.cf_v);
+  if (!lookup.v || !lookup.cf_v)
+    CCTK_ERROR("allocation failure in TwoPunctures_CacheLookup()");
+
+  if (CCTK_MyProc(cctkGH) == 0) {
+    if (read_solution(nvar, n1, n2, n3, lookup.v, lookup.cf_v, &masses[0],
+                      &masses[1]))
+      found = LOOKUP_SOLUTION;
+    else if (!use_external_initial_guess &&
+             guess_solution(nvar, n1, n2, n3, lookup.v, &masses[0],
+                            &masses[1]))
+      found = LOOKUP_GUESS;
+  }
+
+  MPI_Bcast(&found, 1, MPI_INT, 0, MPI_COMM_WORLD);
+  if (found == LOOKUP_NONE) {
+    free_lookup();
+    return;
+  }
+  MPI_Bcast(lookup.v, ntotal * sizeof *lookup.v, MPI_BYTE, 0,
+            MPI_COMM_WORLD);
+  if (found == LOOKUP_SOLUTION)
+    MPI_Bcast(lookup.cf_v, ntotal * sizeof *lookup.cf_v, MPI_BYTE, 0,
+              MPI_COMM_WORLD);
+  MPI_Bcast(masses, sizeof masses, MPI_BYTE, 0, MPI_COMM_WORLD);
+  lookup.found = found;
+  lookup.mp = masses[0];
+  lookup.mm = masses[1];
+
+  if (!give_bare_mass)
+    set_bare_masses(lookup.mp, lookup.mm);
+}
+
+/* -------------------------------------------------------------------*/
+/* Copy the cached solution for the current parameters into v.d0 and
+   cf_v.d0. Returns 1 if TwoPunctures_CacheLookup found it, and sets the
+   bare masses mp and mm. */
+int Cache_ReadSolution(int nvar, int n1, int n2, int n3, derivs v,
+                       derivs cf_v, CCTK_REAL *mp, CCTK_REAL *mm) {
+  int const ntotal = nvar * n1 * n2 * n3;
+
+  if (lookup.found != LOOKUP_SOLUTION || lookup.ntotal != ntotal)
+    return 0;
+  memcpy(v.d0, lookup.v, ntotal * sizeof *v.d0);
+  memcpy(cf_v.d0, lookup.cf_v, ntotal * sizeof *cf_v.d0);
+  *mp = lookup.mp;
+  *mm = lookup.mm;
+  free_lookup();
+  return 1;
+}
+
+/* -------------------------------------------------------------------*/
+/* Use the cached solution with the closest parameters as initial guess
+   in v.d0. If the bare masses are not given, take their initial guesses
+   mp and mm from it as well. Returns 1 if TwoPunctures_CacheLookup found
+   such a solution. */
+int Cache_GuessSolution(int nvar, int n1, int n2, int n3, derivs v,
+                        CCTK_REAL *mp, CCTK_REAL *mm) {
+  DECLARE_CCTK_PARAMETERS;
+  int const ntotal = nvar * n1 * n2 * n3;
+
+  if (lookup.found != LOOKUP_GUESS || lookup.ntotal != ntotal)
+    return 0;
+  memcpy(v.d0, lookup.v, ntotal * sizeof *v.d0);
+  if (!give_bare_mass) {
+    *mp = lookup.mp;
+    *mm = lookup.mm;
+  }
+  free_lookup();
+  return 1;
+}
+
+/* -------------------------------------------------------------------*/
+/* Add the solution v.d0, cf_v.d0 and its masses to the cache. The file
+   is written under a temporary name and then renamed, so that
+   concurrent runs never see a partial file. Call this in global mode on
+   all processes; only process 0 writes. */
+void Cache_WriteSolution(CCTK_POINTER_TO_CONST cctkGH, int nvar, int n1,
+                         int n2, int n3, derivs v, derivs cf_v, CCTK_REAL mp,
+                         CCTK_REAL mm, CCTK_REAL mp_adm, CCTK_REAL mm_adm,
+                         CCTK_REAL E) {
+  DECLARE_CCTK_PARAMETERS;
+  size_t const ntotal = (size_t)nvar * n1 * n2 * n3;
+  cache_header header;
+  char name[1000], tmpname[1100];
+  FILE *file;
+  int ok;
+
+  if (CCTK_MyProc(cctkGH) != 0)
+    return;
+
+  memset(&header, 0, sizeof header);
+  memcpy(header.magic, cache_magic, sizeof cache_magic);
+  make_key(&header.key, nvar, n1, n2, n3);
+  header.mp = mp;
+  header.mm = mm;
+  header.mp_adm = mp_adm;
+  header.mm_adm = mm_adm;
+  header.E = E;
+
+  CCTK_CreateDirectory(0755, cache_dir());
+  snprintf(name, sizeof name, "%s/TwoPunctures-%016llx.dat", cache_dir(),
+           (unsigned long long)hash_key(&header.key));
+  snprintf(tmpname, sizeof tmpname, "%s.tmp%ld", name, (long)getpid());
+
+  file = fopen(tmpname, "wb");
+  if (!file) {
+    CCTK_VWARN(CCTK_WARN_ALERT, "Could not write cached solution \"%s\"",
+               tmpname);
+    return;
+  }
+  ok = fwrite(&header, sizeof header, 1, file) == 1 &&
+       fwrite(v.d0, sizeof *v.d0, ntotal, file) == ntotal &&
+       fwrite(cf_v.d0, sizeof *cf_v.d0, ntotal, file) == ntotal;
+  ok = fclose(file) == 0 && ok;
+  if (!ok || rename(tmpname, name) != 0) {
+    CCTK_VWARN(CCTK_WARN_ALERT, "Could not write cached solution \"%s\"",
+               name);
+    remove(tmpname);
+    return;
+  }
+  CCTK_VINFO("Wrote cached solution \"%s\"", name);
+}
@@ -74,96 +74,101 @@ void free_derivs(derivs *v, int n) {
 
 /* --------------------------------------------------------------------------*/
 void Derivatives_AB3(int nvar, int n1, int n2, int n3, derivs v) {
-  int i, j, k, ivar, N, *indx;
-  CCTK_REAL *p, *dp, *d2p, *q, *dq, *r, *dr;
-
-  N = maximum3(n1, n2, n3);
-  p = dvector(0, N);
-  dp = dvector(0, N);
-  d2p = dvector(0, N);
-  q = dvector(0, N);
-  dq = dvector(0, N);
-  r = dvector(0, N);
-  dr = dvector(0, N);
-  indx = ivector(0, N);
-
-  for (ivar = 0; ivar < nvar; ivar++) {
-    for (k = 0; k < n3; k++) {   /* Calculation of Derivatives w.r.t. A-Dir. */
-      for (j = 0; j < n2; j++) { /* (Chebyshev_Zeros)*/
-        for (i = 0; i < n1; i++) {
-          indx[i] = Index(ivar, i, j, k, nvar, n1, n2, n3);
-          p[i] = v.d0[indx[i]];
-        }
-        chebft_Zeros(p, n1, 0);
-        chder(p, dp, n1);
-        chder(dp, d2p, n1);
-        chebft_Zeros(dp, n1, 1);
-        chebft_Zeros(d2p, n1, 1);
-        for (i = 0; i < n1; i++) {
-          v.d1[indx[i]] = dp[i];
-          v.d11[indx[i]] = d2p[i];
+  int const N = maximum3(n1, n2, n3);
+
+  /* The lines in each direction are transformed independently; the
+     implied barrier after each direction orders the directions. */
+#pragma omp parallel
+  {
+    int *indx = ivector(0, N);
+    CCTK_REAL *p = dvector(0, N), *dp = dvector(0, N), *d2p = dvector(0, N),
+              *q = dvector(0, N), *dq = dvector(0, N), *r = dvector(0, N),
+              *dr = dvector(0, N);
+
+    for (int ivar = 0; ivar < nvar; ivar++) {
+      /* Calculation of Derivatives w.r.t. A-Dir. (Chebyshev_Zeros)*/
+#pragma omp for collapse(2) schedule(static)
+      for (int k = 0; k < n3; k++) {
+        for (int j = 0; j < n2; j++) {
+          for (int i = 0; i < n1; i++) {
+            indx[i] = Index(ivar, i, j, k, nvar, n1, n2, n3);
+            p[i] = v.d0[indx[i]];
+          }
+          chebft_Zeros(p, n1, 0);
+          chder(p, dp, n1);
+          chder(dp, d2p, n1);
+          chebft_Zeros(dp, n1, 1);
+          chebft_Zeros(d2p, n1, 1);
+          for (int i = 0; i < n1; i++) {
+            v.d1[indx[i]] = dp[i];
+            v.d11[indx[i]] = d2p[i];
+          }
         }
       }
-    }
-    for (k = 0; k < n3; k++) {   /* Calculation of Derivatives w.r.t. B-Dir. */
-      for (i = 0; i < n1; i++) { /* (Chebyshev_Zeros)*/
-        for (j = 0; j < n2; j++) {
-          indx[j] = Index(ivar, i, j, k, nvar, n1, n2, n3);
-          p[j] = v.d0[indx[j]];
-          q[j] = v.d1[indx[j]];
-        }
-        chebft_Zeros(p, n2, 0);
-        chebft_Zeros(q, n2, 0);
-        chder(p, dp, n2);
-        chder(dp, d2p, n2);
-        chder(q, dq, n2);
-        chebft_Zeros(dp, n2, 1);
-        chebft_Zeros(d2p, n2, 1);
-        chebft_Zeros(dq, n2, 1);
-        for (j = 0; j < n2; j++) {
-          v.d2[indx[j]] = dp[j];
-          v.d22[indx[j]] = d2p[j];
-          v.d12[indx[j]] = dq[j];
+      /* Calculation of Derivatives w.r.t. B-Dir. (Chebyshev_Zeros)*/
+#pragma omp for collapse(2) schedule(static)
+      for (int k = 0; k < n3; k++) {
+        for (int i = 0; i < n1; i++) {
+          for (int j = 0; j < n2; j++) {
+            indx[j] = Index(ivar, i, j, k, nvar, n1, n2, n3);
+            p[j] = v.d0[indx[j]];
+            q[j] = v.d1[indx[j]];
+          }
+          chebft_Zeros(p, n2, 0);
+          chebft_Zeros(q, n2, 0);
+          chder(p, dp, n2);
+          chder(dp, d2p, n2);
+          chder(q, dq, n2);
+          chebft_Zeros(dp, n2, 1);
+          chebft_Zeros(d2p, n2, 1);
+          chebft_Zeros(dq, n2, 1);
+          for (int j = 0; j < n2; j++) {
+            v.d2[indx[j]] = dp[j];
+            v.d22[indx[j]] = d2p[j];
+            v.d12[indx[j]] = dq[j];
+          }
         }
       }
-    }
-    for (i = 0; i < n1;
-         i++) { /* Calculation of Derivatives w.r.t. phi-Dir. (Fourier)*/
-      for (j = 0; j < n2; j++) {
-        for (k = 0; k < n3; k++) {
-          indx[k] = Index(ivar, i, j, k, nvar, n1, n2, n3);
-          p[k] = v.d0[indx[k]];
-          q[k] = v.d1[indx[k]];
-          r[k] = v.d2[indx[k]];
-        }
-        fourft(p, n3, 0);
-        fourder(p, dp, n3);
-        fourder2(p, d2p, n3);
-        fourft(dp, n3, 1);
-        fourft(d2p, n3, 1);
-        fourft(q, n3, 0);
-        fourder(q, dq, n3);
-        fourft(dq, n3, 1);
-        fourft(r, n3, 0);
-        fourder(r, dr, n3);
-        fourft(dr, n3, 1);
-        for (k = 0; k < n3; k++) {
-          v.d3[indx[k]] = dp[k];
-          v.d33[indx[k]] = d2p[k];
-          v.d13[indx[k]] = dq[k];
-          v.d23[indx[k]] = dr[k];
+      /* Calculation of Derivatives w.r.t. phi-Dir. (Fourier)*/
+#pragma omp for collapse(2) schedule(static)
+      for (int i = 0; i < n1; i++) {
+        for (int j = 0; j < n2; j++) {
+          for (int k = 0; k < n3; k++) {
+            indx[k] = Index(ivar, i, j, k, nvar, n1, n2, n3);
+            p[k] = v.d0[indx[k]];
+            q[k] = v.d1[indx[k]];
+            r[k] = v.d2[indx[k]];
+          }
+          fourft(p, n3, 0);
+          fourder(p, dp, n3);
+          fourder2(p, d2p, n3);
+          fourft(dp, n3, 1);
+          fourft(d2p, n3, 1);
+          fourft(q, n3, 0);
+          fourder(q, dq, n3);
+          fourft(dq, n3, 1);
+          fourft(r, n3, 0);
+          fourder(r, dr, n3);
+          fourft(dr, n3, 1);
+          for (int k = 0; k < n3; k++) {
+            v.d3[indx[k]] = dp[k];
+            v.d33[indx[k]] = d2p[k];
+            v.d13[indx[k]] = dq[k];
+            v.d23[indx[k]] = dr[k];
+          }
         }
       }
     }
+
+    free_dvector(p, 0, N);
+    free_dvector(dp, 0, N);
+    free_dvector(d2p, 0, N);
+    free_dvector(q, 0, N);
+    free_dvector(dq, 0, N);
+    free_dvector(r, 0, N);
+    free_dvector(dr, 0, N);
+    free_ivector(indx, 0, N);
   }
-  free_dvector(p, 0, N);
-  free_dvector(dp, 0, N);
-  free_dvector(d2p, 0, N);
-  free_dvector(q, 0, N);
-  free_dvector(dq, 0, N);
-  free_dvector(r, 0, N);
-  free_dvector(dr, 0, N);
-  free_ivector(indx, 0, N);
 }
 
 /* --------------------------------------------------------------------------*/
@@ -243,7 +248,17 @@ void F_of_v(CCTK_POINTER_TO_CONST cctkGH, int nvar, int n1, int n2, int n3,
     debugfile = fopen("res.dat", "w");
     assert(debugfile);
   }
+  free_dvector(values, 0, nvar - 1);
+  free_derivs(&U, nvar);
+
+  /* The debug output is written in order, so that it needs a serial loop */
+#pragma omp parallel for if (!debugfile)                                       \
+    private(values, U, j, k, al, A, be, B, phi, X, R, x, r, y, z, Am1, ivar,   \
+                indx, psi, psi2, psi4, psi7, r_plus, r_minus)                  \
+    schedule(dynamic)
   for (i = 0; i < n1; i++) {
+    values = dvector(0, nvar - 1);
+    allocate_derivs(&U, nvar);
     for (j = 0; j < n2; j++) {
       for (k = 0; k < n3; k++) {
 
@@ -317,13 +332,13 @@ void F_of_v(CCTK_POINTER_TO_CONST cctkGH, int nvar, int n1, int n2, int n3,
         }
       }
     }
+    free_dvector(values, 0, nvar - 1);
+    free_derivs(&U, nvar);
   }
   if (debugfile) {
     fclose(debugfile);
   }
   free(sources);
-  free_dvector(values, 0, nvar - 1);
-  free_derivs(&U, nvar);
 }
 
 /* --------------------------------------------------------------------------*/
@@ -341,9 +356,9 @@ void J_times_dv(int nvar, int n1, int n2, int n3, derivs dv, CCTK_REAL *Jdv,
 
   Derivatives_AB3(nvar, n1, n2, n3, dv);
 
-  // #pragma omp parallel for private
-  // (values,dU,U,i,j,k,al,A,be,B,phi,X,R,x,r,y,z,Am1,ivar,indx)
-  // schedule(dynamic)
+#pragma omp parallel for private(values, dU, U, j, k, al, A, be, B, phi, X, R, \
+                                     x, r, y, z, Am1, ivar, indx)              \
+    schedule(dynamic)
   for (i = 0; i < n1; i++) {
     values = dvector(0, nvar - 1);
     allocate_derivs(&dU, nvar);
@@ -547,76 +562,69 @@ void JFD_times_dv(
 /* --------------------------------------------------------------------------*/
 void SetMatrix_JFD(int nvar, int n1, int n2, int n3, derivs u, int *ncols,
                    int **cols, CCTK_REAL **Matrix) {
-  DECLARE_CCTK_PARAMETERS;
-  int column, row, mcol;
-  int i, i1, i_0, i_1, j, j1, j_0, j_1, k, k1, k_0, k_1, N1, N2, N3, ivar,
-      ivar1, ntotal = nvar * n1 * n2 * n3;
-  CCTK_REAL *values;
-  derivs dv;
-
-  values = dvector(0, nvar - 1);
-  allocate_derivs(&dv, ntotal);
-
-  N1 = n1 - 1;
-  N2 = n2 - 1;
-  N3 = n3 - 1;
+  int const ntotal = nvar * n1 * n2 * n3;
+
+  /* The matrix is assembled point by point: every thread probes the
+     columns of the (at most 27) neighbouring points with a unit vector
+     in its own copy of dv, and fills only the rows of its point.
+     Columns are visited in increasing order of (i, j, k, ivar), so
+     that every row holds its entries in the same order as if the
+     matrix had been assembled column by column. */
+#pragma omp parallel
+  {
+    CCTK_REAL *values = dvector(0, nvar - 1);
+    derivs dv;
+    allocate_derivs(&dv, ntotal);
+    for (int n = 0; n < ntotal; n++)
+      dv.d0[n] = 0;
+
+#pragma omp for collapse(3) schedule(dynamic)
+    for (int i1 = 0; i1 < n1; i1++) {
+      for (int j1 = 0; j1 < n2; j1++) {
+        for (int k1 = 0; k1 < n3; k1++) {
+          /* the periodic neighbours k1-1, k1, k1+1, in increasing order */
+          int kk[3] = {(k1 + n3 - 1) % n3, k1, (k1 + 1) % n3};
+          for (int m = 1; m < 3; m++)
+            for (int m1 = m; m1 > 0 && kk[m1 - 1] > kk[m1]; m1--) {
+              int const t = kk[m1];
+              kk[m1] = kk[m1 - 1];
+              kk[m1 - 1] = t;
+            }
 
-  // #pragma omp parallel for private (i,j,k,ivar,row) schedule(dynamic)
-  for (i = 0; i < n1; i++) {
-    for (j = 0; j < n2; j++) {
-      for (k = 0; k < n3; k++) {
-        for (ivar = 0; ivar < nvar; ivar++) {
-          row = Index(ivar, i, j, k, nvar, n1, n2, n3);
-          ncols[row] = 0;
-          dv.d0[row] = 0;
-        }
-      }
-    }
-  }
-  for (i = 0; i < n1; i++) {
-    for (j = 0; j < n2; j++) {
-      for (k = 0; k < n3; k++) {
-        for (ivar = 0; ivar < nvar; ivar++) {
-          column = Index(ivar, i, j, k, nvar, n1, n2, n3);
-          dv.d0[column] = 1;
-
-          i_0 = maximum2(0, i - 1);
-          i_1 = minimum2(N1, i + 1);
-          j_0 = maximum2(0, j - 1);
-          j_1 = minimum2(N2, j + 1);
-          k_0 = k - 1;
-          k_1 = k + 1;
-          /*					i_0 = 0;
-                                                  i_1 = N1;
-                                                  j_0 = 0;
-                                                  j_1 = N2;
-                                                  k_0 = 0;
-                                                  k_1 = N3;*/
-
-          for (i1 = i_0; i1 <= i_1; i1++) {
-            for (j1 = j_0; j1 <= j_1; j1++) {
-              for (k1 = k_0; k1 <= k_1; k1++) {
-                JFD_times_dv(i1, j1, k1, nvar, n1, n2, n3, dv, u, values);
-                for (ivar1 = 0; ivar1 < nvar; ivar1++) {
-                  if (values[ivar1] != 0) {
-                    row = Index(ivar1, i1, j1, k1, nvar, n1, n2, n3);
-                    mcol = ncols[row];
-                    cols[row][mcol] = column;
-                    Matrix[row][mcol] = values[ivar1];
-                    ncols[row] += 1;
+          for (int ivar1 = 0; ivar1 < nvar; ivar1++)
+            ncols[Index(ivar1, i1, j1, k1, nvar, n1, n2, n3)] = 0;
+
+          for (int i = maximum2(0, i1 - 1); i <= minimum2(n1 - 1, i1 + 1);
+               i++) {
+            for (int j = maximum2(0, j1 - 1); j <= minimum2(n2 - 1, j1 + 1);
+                 j++) {
+              for (int m = 0; m < 3; m++) {
+                for (int ivar = 0; ivar < nvar; ivar++) {
+                  int const column = Index(ivar, i, j, kk[m], nvar, n1, n2, n3);
+                  dv.d0[column] = 1;
+                  JFD_times_dv(i1, j1, k1, nvar, n1, n2, n3, dv, u, values);
+                  dv.d0[column] = 0;
+                  for (int ivar1 = 0; ivar1 < nvar; ivar1++) {
+                    if (values[ivar1] != 0) {
+                      int const row =
+                          Index(ivar1, i1, j1, k1, nvar, n1, n2, n3);
+                      int const mcol = ncols[row];
+                      cols[row][mcol] = column;
+                      Matrix[row][mcol] = values[ivar1];
+                      ncols[row] += 1;
+                    }
                   }
                 }
               }
             }
           }
-
-          dv.d0[column] = 0;
         }
       }
     }
+
+    free_derivs(&dv, ntotal);
+    free_dvector(values, 0, nvar - 1);
   }
-  free_derivs(&dv, ntotal);
-  free_dvector(values, 0, nvar - 1);
 }
 
 /* --------------------------------------------------------------------------*/
@@ -871,6 +879,137 @@ PunctIntPolAtArbitPositionFast(int ivar, int nvar, int n1, int n2, int n3,
   return Ui;
 }
 
+/* --------------------------------------------------------------------------*/
+/* Calculates the values U of v at the npoints positions (x,y,z) from the
+   spectral coefficients v, like PunctIntPolAtArbitPositionFast. The points
+   are processed in batches of TP_BATCH, for which the Clenshaw recurrences
+   in A, B and phi run across blocks of TP_BLOCK points and vectorise. The
+   maps to (A,B) and phi are written without transcendental functions:
+     tanh(asinh(s) / 2) = s / (1 + sqrt(1 + s^2)),
+     tan(asin(q) / 2) = q / (1 + sqrt(1 - q^2)),
+   and cos(phi), sin(phi) follow from (y,z) directly. The batches are
+   distributed over the OpenMP threads, each with its own scratch space. */
+#define TP_BATCH 64 /* points per batch */
+#define TP_BLOCK 8  /* points whose recurrences are kept in registers */
+void PunctIntPolAtArbitPositionBatch(int ivar, int nvar, int n1, int n2,
+                                     int n3, derivs v, int npoints,
+                                     CCTK_REAL const *restrict x,
+                                     CCTK_REAL const *restrict y,
+                                     CCTK_REAL const *restrict z,
+                                     CCTK_REAL *restrict U) {
+  DECLARE_CCTK_PARAMETERS;
+  int const M = n3 / 2;
+#pragma omp parallel
+  {
+    CCTK_REAL *restrict const work = dvector(0, (4 + n2 + n3) * TP_BATCH - 1);
+    CCTK_REAL *restrict const A = work, *restrict const B = A + TP_BATCH,
+                              *restrict const cos_phi = B + TP_BATCH,
+                              *restrict const sin_phi = cos_phi + TP_BATCH,
+                              *restrict const values2 = sin_phi + TP_BATCH,
+                              *restrict const values1 =
+                                  values2 + n2 * TP_BATCH;
+
+#pragma omp for schedule(static)
+    for (int p0 = 0; p0 < npoints; p0 += TP_BATCH) {
+      int const np = minimum2(TP_BATCH, npoints - p0);
+
+      /* Coordinates (A, B, phi) of the points. A partial batch is padded
+         by repeating its last point. */
+#pragma omp simd
+      for (int p = 0; p < TP_BATCH; p++) {
+        int const pp = p0 + minimum2(p, np - 1);
+        CCTK_REAL const xs = x[pp] / par_b, ys = y[pp] / par_b,
+                        zs = z[pp] / par_b, rs2 = ys * ys + zs * zs,
+                        aux1 = 0.5 * (xs * xs + rs2 - 1),
+                        aux2 = sqrt(aux1 * aux1 + rs2), s = sqrt(aux1 + aux2),
+                        q = min(1.0, sqrt(-aux1 + aux2)), c = sqrt(1 - q * q),
+                        rs = sqrt(rs2);
+        A[p] = 2 * s / (1 + sqrt(1 + s * s)) - 1;
+        /* B = tan(R / 2 - pi / 4), where R = pi - asin(q) for x < 0 */
+        B[p] = (x[pp] < 0 ? -1 : 1) * (q - 1 - c) / (q + 1 + c);
+        /* On the axis, phi = atan2(z, y) is 0 or pi */
+        cos_phi[p] = rs > 0 ? ys / rs : copysign(1.0, ys);
+        sin_phi[p] = rs > 0 ? zs / rs : 0;
+      }
+
+      for (int k = 0; k < n3; k++) {
+        /* Chebyshev series in A for every j */
+        for (int j = 0; j < n2; j++) {
+          CCTK_REAL const *restrict const cf =
+              &v.d0[ivar + nvar * n1 * (j + n2 * k)];
+          for (int p = 0; p < TP_BATCH; p += TP_BLOCK) {
+            CCTK_REAL d0[TP_BLOCK] = {0}, d1[TP_BLOCK] = {0};
+            for (int i = n1 - 1; i >= 1; i--) {
+              CCTK_REAL const ci = cf[nvar * i];
+#pragma omp simd
+              for (int q = 0; q < TP_BLOCK; q++) {
+                CCTK_REAL const t = 2 * A[p + q] * d0[q] - d1[q] + ci;
+                d1[q] = d0[q];
+                d0[q] = t;
+              }
+            }
+#pragma omp simd
+            for (int q = 0; q < TP_BLOCK; q++)
+              values2[j * TP_BATCH + p + q] =
+                  A[p + q] * d0[q] - d1[q] + 0.5 * cf[0];
+          }
+        }
+        /* Chebyshev series in B */
+        for (int p = 0; p < TP_BATCH; p += TP_BLOCK) {
+          CCTK_REAL d0[TP_BLOCK] = {0}, d1[TP_BLOCK] = {0};
+          for (int j = n2 - 1; j >= 1; j--) {
+#pragma omp simd
+            for (int q = 0; q < TP_BLOCK; q++) {
+              CCTK_REAL const t =
+                  2 * B[p + q] * d0[q] - d1[q] + values2[j * TP_BATCH + p + q];
+              d1[q] = d0[q];
+              d0[q] = t;
+            }
+          }
+#pragma omp simd
+          for (int q = 0; q < TP_BLOCK; q++)
+            values1[k * TP_BATCH + p + q] =
+                B[p + q] * d0[q] - d1[q] + 0.5 * values2[p + q];
+        }
+      }
+
+      /* Fourier series in phi, as in fourev: the cosine coefficients are
+         u_0/2, u_1, ..., u_{M-1}, u_M/2 (recurrence in c0, c1), the sine
+         coefficients u_{M+1}, ..., u_{2M-1} (recurrence in s0, s1). The
+         first step l = M has no sine coefficient. */
+      for (int p = 0; p < TP_BATCH; p += TP_BLOCK) {
+        CCTK_REAL c0[TP_BLOCK], c1[TP_BLOCK] = {0}, s0[TP_BLOCK] = {0},
+                                s1[TP_BLOCK] = {0};
+#pragma omp simd
+        for (int q = 0; q < TP_BLOCK; q++)
+          c0[q] = 0.5 * values1[M * TP_BATCH + p + q];
+        for (int l = M - 1; l >= 1; l--) {
+          CCTK_REAL const *restrict const cl = &values1[l * TP_BATCH + p];
+          CCTK_REAL const *restrict const sl =
+              &values1[(M + l) * TP_BATCH + p];
+#pragma omp simd
+          for (int q = 0; q < TP_BLOCK; q++) {
+            CCTK_REAL const tc = cl[q] + 2 * cos_phi[p + q] * c0[q] - c1[q];
+            CCTK_REAL const ts = sl[q] + 2 * cos_phi[p + q] * s0[q] - s1[q];
+            c1[q] = c0[q];
+            c0[q] = tc;
+            s1[q] = s0[q];
+            s0[q] = ts;
+          }
+        }
+        for (int q = 0; q < TP_BLOCK && p + q < np; q++) {
+          CCTK_REAL const result = 0.5 * values1[p + q] +
+                                   c0[q] * cos_phi[p + q] - c1[q] +
+                                   s0[q] * sin_phi[p + q];
+          U[p0 + p + q] = (A[p + q] - 1) * result;
+        }
+      }
+    }
+
+    free_dvector(work, 0, (4 + n2 + n3) * TP_BATCH - 1);
+  }
+}
+
 // Evaluates the spectral expansion coefficients of v
 void SpecCoef(int n1, int n2, int n3, int ivar, CCTK_REAL *v, CCTK_REAL *cf) {
   DECLARE_CCTK_PARAMETERS;
@@ -932,3 +1071,75 @@ void SpecCoef(int n1, int n2, int n3, int ivar, CCTK_REAL *v, CCTK_REAL *cf) {
   free_d3tensor(values3, 0, n1, 0, n2, 0, n3);
   free_d3tensor(values4, 0, n1, 0, n2, 0, n3);
 }
+
+/* --------------------------------------------------------------------------*/
+/* Calculates the values v at the m1 x m2 x m3 collocation points from the
+   n1 x n2 x n3 spectral coefficients cf (as returned by SpecCoef), by
+   padding the coefficients with zeros (or truncating them) and transforming
+   back. With m1 >= n1, m2 >= n2, m3 >= n3 this prolongs a solution to a
+   finer spectral grid without changing the function it represents. */
+void SpecProlong(int n1, int n2, int n3, int ivar, CCTK_REAL *cf, int m1,
+                 int m2, int m3, CCTK_REAL *v) {
+  int i, j, k, N, M, Mn;
+  CCTK_REAL *p;
+
+  N = maximum3(m1, m2, m3);
+  M = m3 / 2;
+  Mn = n3 / 2;
+  p = dvector(0, N);
+
+  for (i = 0; i < m1 * m2 * m3; i++)
+    v[ivar + i] = 0;
+
+  /* Copy the coefficients. The Fourier coefficients are stored as
+     a_0 ... a_M, b_1 ... b_{M-1}, where a_M enters with weight 1/2. */
+  for (k = 0; k < n3; k++) {
+    CCTK_REAL fac = 1;
+    int kk;
+    if (k <= Mn) {
+      if (k > M)
+        continue;
+      kk = k;
+      fac = (k == Mn ? 0.5 : 1) / (k == M ? 0.5 : 1);
+    } else {
+      if (k - Mn >= M)
+        continue;
+      kk = M + k - Mn;
+    }
+    for (j = 0; j < minimum2(n2, m2); j++)
+      for (i = 0; i < minimum2(n1, m1); i++)
+        v[ivar + (i + m1 * (j + m2 * kk))] =
+            fac * cf[ivar + (i + n1 * (j + n2 * k))];
+  }
+
+  /* Transform back in phi, B and A */
+  for (i = 0; i < m1; i++) {
+    for (j = 0; j < m2; j++) {
+      for (k = 0; k < m3; k++)
+        p[k] = v[ivar + (i + m1 * (j + m2 * k))];
+      fourft(p, m3, 1);
+      for (k = 0; k < m3; k++)
+        v[ivar + (i + m1 * (j + m2 * k))] = p[k];
+    }
+  }
+  for (i = 0; i < m1; i++) {
+    for (k = 0; k < m3; k++) {
+      for (j = 0; j < m2; j++)
+        p[j] = v[ivar + (i + m1 * (j + m2 * k))];
+      chebft_Zeros(p, m2, 1);
+      for (j = 0; j < m2; j++)
+        v[ivar + (i + m1 * (j + m2 * k))] = p[j];
+    }
+  }
+  for (k = 0; k < m3; k++) {
+    for (j = 0; j < m2; j++) {
+      for (i = 0; i < m1; i++)
+        p[i] = v[ivar + (i + m1 * (j + m2 * k))];
+      chebft_Zeros(p, m1, 1);
+      for (i = 0; i < m1; i++)
+        v[ivar + (i + m1 * (j + m2 * k))] = p[i];
+    }
+  }
+
+  free_dvector(p, 0, N);
+}
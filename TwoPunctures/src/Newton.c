@@ -7,6 +7,10 @@
 #include <ctype.h>
 #include <gsl/gsl_vector.h>
 #include <gsl/gsl_linalg.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "cctk.h"
 #include "cctk_Parameters.h"
 #include "TP_utilities.h"
 #include "TwoPunctures.h"
@@ -15,6 +19,13 @@ static int bicgstab(CCTK_POINTER_TO_CONST const cctkGH, int const nvar,
                     int const n1, int const n2, int const n3, derivs v,
                     derivs dv, int const output, int const itmax,
                     CCTK_REAL const tol, CCTK_REAL *restrict const normres);
+/* Scratch space for the tridiagonal solves of a line relaxation. Every
+   thread of a relaxation sweep owns one per direction. */
+typedef struct TRIDIAG {
+  gsl_vector *diag, *e, *f, *b, *x;
+} tridiag;
+static void allocate_tridiag(tridiag *t, int n);
+static void free_tridiag(tridiag *t);
 static CCTK_REAL norm_inf(CCTK_REAL const *restrict const F, int const ntotal);
 static void relax(CCTK_REAL *restrict const dv, int const nvar, int const n1,
                   int const n2, int const n3,
@@ -33,27 +44,22 @@ static void LineRelax_al(CCTK_REAL *restrict const dv, int const j, int const k,
                          int const n3, CCTK_REAL const *restrict const rhs,
                          int const *restrict const ncols,
                          int const *restrict const *restrict const cols,
-                         CCTK_REAL const *restrict const *restrict const JFD);
+                         CCTK_REAL const *restrict const *restrict const JFD,
+                         tridiag const *restrict const line);
 static void LineRelax_be(CCTK_REAL *restrict const dv, int const i, int const k,
                          int const nvar, int const n1, int const n2,
                          int const n3, CCTK_REAL const *restrict const rhs,
                          int const *restrict const ncols,
                          int const *restrict const *restrict const cols,
-                         CCTK_REAL const *restrict const *restrict const JFD);
+                         CCTK_REAL const *restrict const *restrict const JFD,
+                         tridiag const *restrict const line);
 /* --------------------------------------------------------------------------*/
 static CCTK_REAL norm_inf(CCTK_REAL const *restrict const F, int const ntotal) {
   CCTK_REAL dmax = -1;
-  // #pragma omp parallel
-  {
-    CCTK_REAL dmax1 = -1;
-    // #pragma omp for
-    for (int j = 0; j < ntotal; j++)
-      if (fabs(F[j]) > dmax1)
-        dmax1 = fabs(F[j]);
-    // #pragma omp critical
-    if (dmax1 > dmax)
-      dmax = dmax1;
-  }
+#pragma omp parallel for reduction(max : dmax)
+  for (int j = 0; j < ntotal; j++)
+    if (fabs(F[j]) > dmax)
+      dmax = fabs(F[j]);
   return dmax;
 }
 /* --------------------------------------------------------------------------*/
@@ -63,7 +69,7 @@ static void resid(CCTK_REAL *restrict const res, int const ntotal,
                   int const *restrict const ncols,
                   int const *restrict const *restrict const cols,
                   CCTK_REAL const *restrict const *restrict const JFD) {
-  // #pragma omp parallel for
+#pragma omp parallel for
   for (int i = 0; i < ntotal; i++) {
     CCTK_REAL JFDdv_i = 0;
     for (int m = 0; m < ncols[i]; m++)
@@ -72,20 +78,36 @@ static void resid(CCTK_REAL *restrict const res, int const ntotal,
   }
 }
 
+/* -------------------------------------------------------------------------*/
+static void allocate_tridiag(tridiag *t, int n) {
+  t->diag = gsl_vector_alloc(n);
+  t->e = gsl_vector_alloc(n - 1); /* above diagonal */
+  t->f = gsl_vector_alloc(n - 1); /* below diagonal */
+  t->b = gsl_vector_alloc(n);     /* rhs */
+  t->x = gsl_vector_alloc(n);     /* solution vector */
+}
+
+/* -------------------------------------------------------------------------*/
+static void free_tridiag(tridiag *t) {
+  gsl_vector_free(t->diag);
+  gsl_vector_free(t->e);
+  gsl_vector_free(t->f);
+  gsl_vector_free(t->b);
+  gsl_vector_free(t->x);
+}
+
 /* -------------------------------------------------------------------------*/
 static void LineRelax_al(CCTK_REAL *restrict const dv, int const j, int const k,
                          int const nvar, int const n1, int const n2,
                          int const n3, CCTK_REAL const *restrict const rhs,
                          int const *restrict const ncols,
                          int const *restrict const *restrict const cols,
-                         CCTK_REAL const *restrict const *restrict const JFD) {
+                         CCTK_REAL const *restrict const *restrict const JFD,
+                         tridiag const *restrict const line) {
   int i, m, Ic, Ip, Im, col, ivar;
 
-  gsl_vector *diag = gsl_vector_alloc(n1);
-  gsl_vector *e = gsl_vector_alloc(n1 - 1); /* above diagonal */
-  gsl_vector *f = gsl_vector_alloc(n1 - 1); /* below diagonal */
-  gsl_vector *b = gsl_vector_alloc(n1);     /* rhs */
-  gsl_vector *x = gsl_vector_alloc(n1);     /* solution vector */
+  gsl_vector *const diag = line->diag, *const e = line->e, *const f = line->f,
+                    *const b = line->b, *const x = line->x;
 
   for (ivar = 0; ivar < nvar; ivar++) {
     gsl_vector_set_zero(diag);
@@ -116,12 +138,6 @@ static void LineRelax_al(CCTK_REAL *restrict const dv, int const j, int const k,
       dv[Ic] = gsl_vector_get(x, i);
     }
   }
-
-  gsl_vector_free(diag);
-  gsl_vector_free(e);
-  gsl_vector_free(f);
-  gsl_vector_free(b);
-  gsl_vector_free(x);
 }
 
 /* --------------------------------------------------------------------------*/
@@ -130,14 +146,12 @@ static void LineRelax_be(CCTK_REAL *restrict const dv, int const i, int const k,
                          int const n3, CCTK_REAL const *restrict const rhs,
                          int const *restrict const ncols,
                          int const *restrict const *restrict const cols,
-                         CCTK_REAL const *restrict const *restrict const JFD) {
+                         CCTK_REAL const *restrict const *restrict const JFD,
+                         tridiag const *restrict const line) {
   int j, m, Ic, Ip, Im, col, ivar;
 
-  gsl_vector *diag = gsl_vector_alloc(n2);
-  gsl_vector *e = gsl_vector_alloc(n2 - 1); /* above diagonal */
-  gsl_vector *f = gsl_vector_alloc(n2 - 1); /* below diagonal */
-  gsl_vector *b = gsl_vector_alloc(n2);     /* rhs */
-  gsl_vector *x = gsl_vector_alloc(n2);     /* solution vector */
+  gsl_vector *const diag = line->diag, *const e = line->e, *const f = line->f,
+                    *const b = line->b, *const x = line->x;
 
   for (ivar = 0; ivar < nvar; ivar++) {
     gsl_vector_set_zero(diag);
@@ -168,11 +182,6 @@ static void LineRelax_be(CCTK_REAL *restrict const dv, int const i, int const k,
       dv[Ic] = gsl_vector_get(x, j);
     }
   }
-  gsl_vector_free(diag);
-  gsl_vector_free(e);
-  gsl_vector_free(f);
-  gsl_vector_free(b);
-  gsl_vector_free(x);
 }
 
 /* --------------------------------------------------------------------------*/
@@ -182,39 +191,59 @@ static void relax(CCTK_REAL *restrict const dv, int const nvar, int const n1,
                   int const *restrict const ncols,
                   int const *restrict const *restrict const cols,
                   CCTK_REAL const *restrict const *restrict const JFD) {
-  int i, j, k, n;
-
-  for (k = 0; k < n3; k = k + 2) {
-    for (n = 0; n < N_PlaneRelax; n++) {
-      // #pragma omp parallel for schedule(dynamic)
-      for (i = 2; i < n1; i = i + 2)
-        LineRelax_be(dv, i, k, nvar, n1, n2, n3, rhs, ncols, cols, JFD);
-      // #pragma omp parallel for schedule(dynamic)
-      for (i = 1; i < n1; i = i + 2)
-        LineRelax_be(dv, i, k, nvar, n1, n2, n3, rhs, ncols, cols, JFD);
-      // #pragma omp parallel for schedule(dynamic)
-      for (j = 1; j < n2; j = j + 2)
-        LineRelax_al(dv, j, k, nvar, n1, n2, n3, rhs, ncols, cols, JFD);
-      // #pragma omp parallel for schedule(dynamic)
-      for (j = 0; j < n2; j = j + 2)
-        LineRelax_al(dv, j, k, nvar, n1, n2, n3, rhs, ncols, cols, JFD);
+  /* The stencil of JFD couples only neighbouring lines. The lines of
+     every sweep below (every other line in one plane) can therefore be
+     relaxed concurrently, and the result does not depend on the number
+     of threads. The implied barrier after each sweep orders them. */
+#pragma omp parallel
+  {
+    tridiag line_al, line_be;
+    allocate_tridiag(&line_al, n1);
+    allocate_tridiag(&line_be, n2);
+
+    for (int k = 0; k < n3; k = k + 2) {
+      for (int n = 0; n < N_PlaneRelax; n++) {
+#pragma omp for schedule(dynamic)
+        for (int i = 2; i < n1; i = i + 2)
+          LineRelax_be(dv, i, k, nvar, n1, n2, n3, rhs, ncols, cols, JFD,
+                       &line_be);
+#pragma omp for schedule(dynamic)
+        for (int i = 1; i < n1; i = i + 2)
+          LineRelax_be(dv, i, k, nvar, n1, n2, n3, rhs, ncols, cols, JFD,
+                       &line_be);
+#pragma omp for schedule(dynamic)
+        for (int j = 1; j < n2; j = j + 2)
+          LineRelax_al(dv, j, k, nvar, n1, n2, n3, rhs, ncols, cols, JFD,
+                       &line_al);
+#pragma omp for schedule(dynamic)
+        for (int j = 0; j < n2; j = j + 2)
+          LineRelax_al(dv, j, k, nvar, n1, n2, n3, rhs, ncols, cols, JFD,
+                       &line_al);
+      }
     }
-  }
-  for (k = 1; k < n3; k = k + 2) {
-    for (n = 0; n < N_PlaneRelax; n++) {
-      // #pragma omp parallel for schedule(dynamic)
-      for (i = 0; i < n1; i = i + 2)
-        LineRelax_be(dv, i, k, nvar, n1, n2, n3, rhs, ncols, cols, JFD);
-      // #pragma omp parallel for schedule(dynamic)
-      for (i = 1; i < n1; i = i + 2)
-        LineRelax_be(dv, i, k, nvar, n1, n2, n3, rhs, ncols, cols, JFD);
-      // #pragma omp parallel for schedule(dynamic)
-      for (j = 1; j < n2; j = j + 2)
-        LineRelax_al(dv, j, k, nvar, n1, n2, n3, rhs, ncols, cols, JFD);
-      // #pragma omp parallel for schedule(dynamic)
-      for (j = 0; j < n2; j = j + 2)
-        LineRelax_al(dv, j, k, nvar, n1, n2, n3, rhs, ncols, cols, JFD);
+    for (int k = 1; k < n3; k = k + 2) {
+      for (int n = 0; n < N_PlaneRelax; n++) {
+#pragma omp for schedule(dynamic)
+        for (int i = 0; i < n1; i = i + 2)
+          LineRelax_be(dv, i, k, nvar, n1, n2, n3, rhs, ncols, cols, JFD,
+                       &line_be);
+#pragma omp for schedule(dynamic)
+        for (int i = 1; i < n1; i = i + 2)
+          LineRelax_be(dv, i, k, nvar, n1, n2, n3, rhs, ncols, cols, JFD,
+                       &line_be);
+#pragma omp for schedule(dynamic)
+        for (int j = 1; j < n2; j = j + 2)
+          LineRelax_al(dv, j, k, nvar, n1, n2, n3, rhs, ncols, cols, JFD,
+                       &line_al);
+#pragma omp for schedule(dynamic)
+        for (int j = 0; j < n2; j = j + 2)
+          LineRelax_al(dv, j, k, nvar, n1, n2, n3, rhs, ncols, cols, JFD,
+                       &line_al);
+      }
     }
+
+    free_tridiag(&line_al);
+    free_tridiag(&line_be);
   }
 }
 
@@ -312,7 +341,7 @@ static int bicgstab(CCTK_POINTER_TO_CONST const cctkGH, int const nvar,
 
   /* compute initial residual rt = r = F - J*dv */
   J_times_dv(nvar, n1, n2, n3, dv, r, u);
-  // #pragma omp parallel for
+#pragma omp parallel for
   for (int j = 0; j < ntotal; j++)
     rt[j] = r[j] = F[j] - r[j];
 
@@ -333,18 +362,18 @@ static int bicgstab(CCTK_POINTER_TO_CONST const cctkGH, int const nvar,
 
     /* compute direction vector p */
     if (ii == 0) {
-      // #pragma omp parallel for
+#pragma omp parallel for
       for (int j = 0; j < ntotal; j++)
         p[j] = r[j];
     } else {
       beta = (rho / rho1) * (alpha / omega);
-      // #pragma omp parallel for
+#pragma omp parallel for
       for (int j = 0; j < ntotal; j++)
         p[j] = r[j] + beta * (p[j] - omega * vv[j]);
     }
 
     /* compute direction adjusting vector ph and scalar alpha */
-    // #pragma omp parallel for
+#pragma omp parallel for
     for (int j = 0; j < ntotal; j++)
       ph.d0[j] = 0;
     for (int j = 0; j < NRELAX; j++) /* solves JFD*ph = p by relaxation*/
@@ -352,14 +381,14 @@ static int bicgstab(CCTK_POINTER_TO_CONST const cctkGH, int const nvar,
 
     J_times_dv(nvar, n1, n2, n3, ph, vv, u); /* vv=J*ph*/
     alpha = rho / scalarproduct(rt, vv, ntotal);
-    // #pragma omp parallel for
+#pragma omp parallel for
     for (int j = 0; j < ntotal; j++)
       s[j] = r[j] - alpha * vv[j];
 
     /* early check of tolerance */
     *normres = norm2(s, ntotal);
     if (*normres <= tol) {
-      // #pragma omp parallel for
+#pragma omp parallel for
       for (int j = 0; j < ntotal; j++)
         dv.d0[j] += alpha * ph.d0[j];
       if (output == 1) {
@@ -371,7 +400,7 @@ static int bicgstab(CCTK_POINTER_TO_CONST const cctkGH, int const nvar,
     }
 
     /* compute stabilizer vector sh and scalar omega */
-    // #pragma omp parallel for
+#pragma omp parallel for
     for (int j = 0; j < ntotal; j++)
       sh.d0[j] = 0;
     for (int j = 0; j < NRELAX; j++) /* solves JFD*sh = s by relaxation*/
@@ -381,7 +410,7 @@ static int bicgstab(CCTK_POINTER_TO_CONST const cctkGH, int const nvar,
     omega = scalarproduct(t, s, ntotal) / scalarproduct(t, t, ntotal);
 
     /* compute new solution approximation */
-    // #pragma omp parallel for
+#pragma omp parallel for
     for (int j = 0; j < ntotal; j++) {
       dv.d0[j] += alpha * ph.d0[j] + omega * sh.d0[j];
       r[j] = s[j] - omega * t[j];
@@ -455,7 +484,7 @@ void Newton(CCTK_POINTER_TO_CONST const cctkGH, int const nvar, int const n1,
       F_of_v(cctkGH, nvar, n1, n2, n3, v, F, u);
       dmax = norm_inf(F, ntotal);
     }
-    // #pragma omp parallel for
+#pragma omp parallel for
     for (int j = 0; j < ntotal; j++)
       dv.d0[j] = 0;
 
@@ -468,7 +497,7 @@ void Newton(CCTK_POINTER_TO_CONST const cctkGH, int const nvar, int const n1,
     fflush(stdout);
     ii = bicgstab(cctkGH, nvar, n1, n2, n3, v, dv, verbose, 100, dmax * 1.e-3,
                   &normres);
-    // #pragma omp parallel for
+#pragma omp parallel for
     for (int j = 0; j < ntotal; j++)
       v.d0[j] -= dv.d0[j];
     F_of_v(cctkGH, nvar, n1, n2, n3, v, F, u);
@@ -491,3 +520,42 @@ void Newton(CCTK_POINTER_TO_CONST const cctkGH, int const nvar, int const n1,
 }
 
 /* -------------------------------------------------------------------*/
+/* -------------------------------------------------------------------*/
+void Newton_benchmark(CCTK_POINTER_TO_CONST const cctkGH, int const nvar,
+                      int const n1, int const n2, int const n3, derivs v,
+                      CCTK_REAL const tol, int const itmax) {
+  /* Solve from the initial guess v with 1, 2, 4, ... threads up to the
+     number of available threads, and report the wall-clock times. v
+     is left unchanged. */
+#ifdef _OPENMP
+  int const ntotal = n1 * n2 * n3 * nvar,
+            maxthreads = omp_get_max_threads();
+  CCTK_REAL time1 = 0;
+  derivs w;
+
+  allocate_derivs(&w, ntotal);
+
+  CCTK_VINFO("Benchmarking the Newton solver with up to %d threads",
+             maxthreads);
+  for (int nthreads = 1;; nthreads = minimum2(2 * nthreads, maxthreads)) {
+    memcpy(w.d0, v.d0, ntotal * sizeof *w.d0);
+    omp_set_num_threads(nthreads);
+    double const t0 = omp_get_wtime();
+    Newton(cctkGH, nvar, n1, n2, n3, w, tol, itmax);
+    CCTK_REAL const time = omp_get_wtime() - t0;
+    if (nthreads == 1)
+      time1 = time;
+    CCTK_VINFO("  %3d threads: %9.3f s, speedup %6.2f, efficiency %5.1f%%",
+               nthreads, (double)time, (double)(time1 / time),
+               (double)(100 * time1 / (nthreads * time)));
+    if (nthreads == maxthreads)
+      break;
+  }
+  omp_set_num_threads(maxthreads);
+
+  free_derivs(&w, ntotal);
+#else
+  CCTK_WARN(CCTK_WARN_ALERT,
+            "Not benchmarking the Newton solver: OpenMP is disabled");
+#endif
+}
@@ -22,4 +22,8 @@ void TwoPunctures_ParamCheck(CCTK_ARGUMENTS) {
       CCTK_WARN(0, "Matter sources have been enabled, "
                    "but there is no aliased function for matter sources.");
   }
+
+  if (use_solution_cache && use_sources)
+    CCTK_WARN(0, "The solution cache cannot be used with matter sources, "
+                 "since it does not know about them.");
 }
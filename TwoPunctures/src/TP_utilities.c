@@ -4,6 +4,7 @@
 #include <stdio.h>
 #include <stddef.h>
 #include <stdlib.h>
+#include <stdatomic.h>
 #include <assert.h>
 #include "TP_utilities.h"
 
@@ -227,44 +228,227 @@ int pow_int(int mantisse, int exponent) {
   return result;
 }
 
+/*--------------------------------------------------------------------------*/
+/* Fast transforms
+
+   The Chebyshev and Fourier transforms below are based on a
+   mixed-radix complex FFT. A transform of length n takes O(n log n)
+   operations if n has only small prime factors, and O(n p) for a
+   prime factor p. The twiddle factors are tabulated once per length
+   and kept for the rest of the run; once a plan is published, looking
+   it up takes no lock. Each thread has its own scratch space, which
+   grows to the longest transform it has performed. */
+
+typedef struct fft_plan {
+  int n;
+  CCTK_REAL *wr, *wi; /* exp(-2 pi i k / n), k = 0 ... n-1 */
+  CCTK_REAL *sr, *si; /* exp(-i pi k / (2 n)), k = 0 ... n-1 */
+  struct fft_plan *next;
+} fft_plan;
+
+static _Atomic(fft_plan *) fft_plans = NULL;
+
+static fft_plan *find_fft_plan(int n) {
+  fft_plan *plan;
+  for (plan = atomic_load_explicit(&fft_plans, memory_order_acquire);
+       plan != NULL; plan = plan->next)
+    if (plan->n == n)
+      break;
+  return plan;
+}
+
+static const fft_plan *get_fft_plan(int n) {
+  fft_plan *plan = find_fft_plan(n);
+  if (plan != NULL)
+    return plan;
+
+#pragma omp critical(TP_fft_plans)
+  {
+    plan = find_fft_plan(n);
+    if (plan == NULL) {
+      plan = malloc(sizeof *plan);
+      if (plan == NULL)
+        CCTK_ERROR("allocation failure in get_fft_plan()");
+      plan->n = n;
+      plan->wr = dvector(0, n - 1);
+      plan->wi = dvector(0, n - 1);
+      plan->sr = dvector(0, n - 1);
+      plan->si = dvector(0, n - 1);
+      for (int k = 0; k < n; k++) {
+        plan->wr[k] = cos(2 * Pi * k / n);
+        plan->wi[k] = -sin(2 * Pi * k / n);
+        plan->sr[k] = cos(Pih * k / n);
+        plan->si[k] = -sin(Pih * k / n);
+      }
+      plan->next = atomic_load_explicit(&fft_plans, memory_order_relaxed);
+      atomic_store_explicit(&fft_plans, plan, memory_order_release);
+    }
+  }
+
+  return plan;
+}
+
+/* Scratch space of this thread for a transform with this plan: 2 n
+   values for the caller, followed by 4 n values used by fft() */
+static CCTK_REAL *fft_scratch(const fft_plan *plan) {
+  static _Thread_local CCTK_REAL *scratch = NULL;
+  static _Thread_local int size = 0;
+
+  if (size < 6 * plan->n) {
+    free(scratch);
+    size = 6 * plan->n;
+    scratch = malloc(sizeof *scratch * size);
+    if (scratch == NULL)
+      CCTK_ERROR("allocation failure in fft_scratch()");
+  }
+  return scratch;
+}
+
+/* Transform the n values in[j * stride] (with n * stride equal to the
+   length of the plan) into out[0 ... n-1] by decimation in time.
+   tmp must hold as many values as the largest prime factor of n. */
+static void fft_rec(const fft_plan *plan, int n, int stride,
+                    const CCTK_REAL *inr, const CCTK_REAL *ini,
+                    CCTK_REAL *outr, CCTK_REAL *outi, CCTK_REAL *tmpr,
+                    CCTK_REAL *tmpi) {
+  const int N = plan->n;
+  int p, m;
+
+  if (n == 1) {
+    outr[0] = inr[0];
+    outi[0] = ini[0];
+    return;
+  }
+
+  /* smallest prime factor */
+  for (p = 2; n % p != 0; p++)
+    if (p * p > n) {
+      p = n;
+      break;
+    }
+  m = n / p;
+
+  for (int r = 0; r < p; r++)
+    fft_rec(plan, m, stride * p, inr + r * stride, ini + r * stride,
+            outr + r * m, outi + r * m, tmpr, tmpi);
+
+  /* out[k + q m] = sum_r exp(-2 pi i r (k + q m) / n) sub_r[k] */
+  for (int k = 0; k < m; k++) {
+    for (int r = 0; r < p; r++) {
+      const long t = (long)r * k * stride % N;
+      const CCTK_REAL xr = outr[r * m + k], xi = outi[r * m + k];
+      tmpr[r] = plan->wr[t] * xr - plan->wi[t] * xi;
+      tmpi[r] = plan->wr[t] * xi + plan->wi[t] * xr;
+    }
+    if (p == 2) {
+      outr[k] = tmpr[0] + tmpr[1];
+      outi[k] = tmpi[0] + tmpi[1];
+      outr[k + m] = tmpr[0] - tmpr[1];
+      outi[k + m] = tmpi[0] - tmpi[1];
+      continue;
+    }
+    for (int q = 0; q < p; q++) {
+      CCTK_REAL yr = 0, yi = 0;
+      for (int r = 0; r < p; r++) {
+        const long t = (long)r * q * m * stride % N;
+        yr += plan->wr[t] * tmpr[r] - plan->wi[t] * tmpi[r];
+        yi += plan->wr[t] * tmpi[r] + plan->wi[t] * tmpr[r];
+      }
+      outr[k + q * m] = yr;
+      outi[k + q * m] = yi;
+    }
+  }
+}
+
+/* In-place forward transform,
+   x_k <- sum_j x_j exp(-2 pi i j k / n). x must not lie in the last
+   4 n values of fft_scratch(plan). */
+static void fft(const fft_plan *plan, CCTK_REAL *xr, CCTK_REAL *xi) {
+  const int n = plan->n;
+  CCTK_REAL *work = fft_scratch(plan) + 2 * n;
+
+  fft_rec(plan, n, 1, xr, xi, work, work + n, work + 2 * n, work + 3 * n);
+  for (int k = 0; k < n; k++) {
+    xr[k] = work[k];
+    xi[k] = work[n + k];
+  }
+}
+
+/* DCT-II, y_j = sum_k x_k cos(pi j (k + 1/2) / n), via an FFT of the
+   reordered sequence (Makhoul 1980) */
+static void dct2(CCTK_REAL *x, int n) {
+  const fft_plan *plan = get_fft_plan(n);
+  CCTK_REAL *vr = fft_scratch(plan), *vi = vr + n;
+
+  for (int k = 0; 2 * k < n; k++)
+    vr[k] = x[2 * k];
+  for (int k = 0; 2 * k + 1 < n; k++)
+    vr[n - 1 - k] = x[2 * k + 1];
+  for (int k = 0; k < n; k++)
+    vi[k] = 0;
+  fft(plan, vr, vi);
+  for (int j = 0; j < n; j++)
+    x[j] = plan->sr[j] * vr[j] - plan->si[j] * vi[j];
+}
+
+/* DCT-III, y_j = x_0 / 2 + sum_{k>0} x_k cos(pi (j + 1/2) k / n), the
+   inverse of dct2 up to a factor n/2 */
+static void dct3(CCTK_REAL *x, int n) {
+  const fft_plan *plan = get_fft_plan(n);
+  CCTK_REAL *vr = fft_scratch(plan), *vi = vr + n;
+
+  /* v_k = conj(exp(i pi k / (2 n)) (x_k - i x_{n-k})) / 2, x_n = 0 */
+  for (int k = 0; k < n; k++) {
+    const CCTK_REAL ar = x[k], ai = k == 0 ? 0 : -x[n - k];
+    vr[k] = 0.5 * (plan->sr[k] * ar + plan->si[k] * ai);
+    vi[k] = 0.5 * (plan->si[k] * ar - plan->sr[k] * ai);
+  }
+  fft(plan, vr, vi);
+  for (int k = 0; 2 * k < n; k++)
+    x[2 * k] = vr[k];
+  for (int k = 0; 2 * k + 1 < n; k++)
+    x[2 * k + 1] = vr[n - 1 - k];
+}
+
+/* DCT-I, y_j = (x_0 + (-1)^j x_N) / 2 + sum_{0<k<N} x_k cos(pi j k / N),
+   via an FFT of the even extension of length 2 N */
+static void dct1(CCTK_REAL *x, int n) {
+  const int N = n - 1;
+  const fft_plan *plan = get_fft_plan(2 * N);
+  CCTK_REAL *vr = fft_scratch(plan), *vi = vr + 2 * N;
+
+  for (int k = 0; k <= N; k++)
+    vr[k] = x[k];
+  for (int k = 1; k < N; k++)
+    vr[2 * N - k] = x[k];
+  for (int k = 0; k < 2 * N; k++)
+    vi[k] = 0;
+  fft(plan, vr, vi);
+  for (int j = 0; j <= N; j++)
+    x[j] = 0.5 * vr[j];
+}
+
 /*--------------------------------------------------------------------------*/
 void chebft_Zeros(CCTK_REAL u[], int n, int inv)
 /* eq. 5.8.7 and 5.8.8 at x = (5.8.4) of 2nd edition C++ NR */
 {
-  int k, j, isignum;
-  CCTK_REAL fac, sum, Pion, *c;
+  int j, isignum;
 
-  c = dvector(0, n);
-  Pion = Pi / n;
   if (inv == 0) {
-    fac = 2.0 / n;
+    dct2(u, n);
     isignum = 1;
     for (j = 0; j < n; j++) {
-      sum = 0.0;
-      for (k = 0; k < n; k++)
-        sum += u[k] * cos(Pion * j * (k + 0.5));
-      c[j] = fac * sum * isignum;
+      u[j] *= 2.0 / n * isignum;
       isignum = -isignum;
     }
   } else {
+    isignum = 1;
     for (j = 0; j < n; j++) {
-      sum = -0.5 * u[0];
-      isignum = 1;
-      for (k = 0; k < n; k++) {
-        sum += u[k] * cos(Pion * (j + 0.5) * k) * isignum;
-        isignum = -isignum;
-      }
-      c[j] = sum;
+      u[j] *= isignum;
+      isignum = -isignum;
     }
+    dct3(u, n);
   }
-  for (j = 0; j < n; j++)
-#if 0
-    if (fabs(c[j]) < 5.e-16)
-      u[j] = 0.0;
-    else
-#endif
-    u[j] = c[j];
-  free_dvector(c, 0, n);
 }
 
 /* --------------------------------------------------------------------------*/
@@ -272,36 +456,30 @@ void chebft_Zeros(CCTK_REAL u[], int n, int inv)
 void chebft_Extremes(CCTK_REAL u[], int n, int inv)
 /* eq. 5.8.7 and 5.8.8 at x = (5.8.5) of 2nd edition C++ NR */
 {
-  int k, j, isignum, N = n - 1;
-  CCTK_REAL fac, sum, PioN, *c;
+  int j, isignum, N = n - 1;
 
-  c = dvector(0, N);
-  PioN = Pi / N;
   if (inv == 0) {
-    fac = 2.0 / N;
+    dct1(u, n);
     isignum = 1;
     for (j = 0; j < n; j++) {
-      sum = 0.5 * (u[0] + u[N] * isignum);
-      for (k = 1; k < N; k++)
-        sum += u[k] * cos(PioN * j * k);
-      c[j] = fac * sum * isignum;
+      u[j] *= 2.0 / N * isignum;
       isignum = -isignum;
     }
-    c[N] = 0.5 * c[N];
+    u[N] = 0.5 * u[N];
   } else {
+    isignum = 1;
     for (j = 0; j < n; j++) {
-      sum = -0.5 * u[0];
-      isignum = 1;
-      for (k = 0; k < n; k++) {
-        sum += u[k] * cos(PioN * j * k) * isignum;
-        isignum = -isignum;
-      }
-      c[j] = sum;
+      u[j] *= isignum;
+      isignum = -isignum;
+    }
+    const CCTK_REAL uN = u[N];
+    dct1(u, n);
+    isignum = 1;
+    for (j = 0; j < n; j++) {
+      u[j] += 0.5 * uN * isignum;
+      isignum = -isignum;
     }
   }
-  for (j = 0; j < n; j++)
-    u[j] = c[j];
-  free_dvector(c, 0, N);
 }
 
 /* --------------------------------------------------------------------------*/
@@ -340,57 +518,47 @@ chebev(CCTK_REAL a, CCTK_REAL b, CCTK_REAL c[], int m, CCTK_REAL x)
 
 /* --------------------------------------------------------------------------*/
 void fourft(CCTK_REAL *u, int N, int inv)
-/* a (slow) Fourier transform, seems to be just eq. 12.1.6 and 12.1.9 of C++ NR
-   (2nd ed) */
+/* a Fourier transform, eq. 12.1.6 and 12.1.9 of C++ NR (2nd ed), for
+   even N. The coefficients are stored as a_0 ... a_M, b_1 ... b_{M-1}
+   with M = N/2. */
 {
-  int l, k, iy, M;
-  CCTK_REAL x, x1, fac, Pi_fac, *a, *b;
+  int l, k, M;
+  const fft_plan *plan = get_fft_plan(N);
+  CCTK_REAL fac, *vr, *vi;
 
   M = N / 2;
-  a = dvector(0, M);
-  b = dvector(1,
-              M); /* Actually: b=vector(1,M-1) but this is problematic if M=1*/
-  fac = 1. / M;
-  Pi_fac = Pi * fac;
+  vr = fft_scratch(plan);
+  vi = vr + N;
   if (inv == 0) {
-    for (l = 0; l <= M; l++) {
-      a[l] = 0;
-      if (l > 0 && l < M)
-        b[l] = 0;
-      x1 = Pi_fac * l;
-      for (k = 0; k < N; k++) {
-        x = x1 * k;
-        a[l] += fac * u[k] * cos(x);
-        if (l > 0 && l < M)
-          b[l] += fac * u[k] * sin(x);
-      }
+    for (k = 0; k < N; k++) {
+      vr[k] = u[k];
+      vi[k] = 0;
     }
-    u[0] = a[0];
-    u[M] = a[M];
+    fft(plan, vr, vi);
+    fac = 1. / M;
+    u[0] = fac * vr[0];
+    u[M] = fac * vr[M];
     for (l = 1; l < M; l++) {
-      u[l] = a[l];
-      u[l + M] = b[l];
+      u[l] = fac * vr[l];
+      u[l + M] = -fac * vi[l];
     }
   } else {
-    a[0] = u[0];
-    a[M] = u[M];
+    /* u_k = Re sum_l z_l exp(2 pi i l k / N) with z_0 = a_0 / 2,
+       z_M = a_M / 2, z_l = (a_l - i b_l) / 2, and z_{N-l} = conj(z_l).
+       We transform conj(z) forward. */
+    vr[0] = 0.5 * u[0];
+    vi[0] = 0;
+    vr[M] = 0.5 * u[M];
+    vi[M] = 0;
     for (l = 1; l < M; l++) {
-      a[l] = u[l];
-      b[l] = u[M + l];
-    }
-    iy = 1;
-    for (k = 0; k < N; k++) {
-      u[k] = 0.5 * (a[0] + a[M] * iy);
-      x1 = Pi_fac * k;
-      for (l = 1; l < M; l++) {
-        x = x1 * l;
-        u[k] += a[l] * cos(x) + b[l] * sin(x);
-      }
-      iy = -iy;
+      vr[l] = vr[N - l] = 0.5 * u[l];
+      vi[l] = 0.5 * u[M + l];
+      vi[N - l] = -vi[l];
     }
+    fft(plan, vr, vi);
+    for (k = 0; k < N; k++)
+      u[k] = vr[k];
   }
-  free_dvector(a, 0, M);
-  free_dvector(b, 1, M);
 }
 
 /* -----------------------------------------*/
@@ -442,6 +610,7 @@ norm1(CCTK_REAL *v, int n) {
   int i;
   CCTK_REAL result = -1;
 
+#pragma omp parallel for reduction(max : result)
   for (i = 0; i < n; i++)
     if (fabs(v[i]) > result)
       result = fabs(v[i]);
@@ -455,6 +624,7 @@ norm2(CCTK_REAL *v, int n) {
   int i;
   CCTK_REAL result = 0;
 
+#pragma omp parallel for reduction(+ : result)
   for (i = 0; i < n; i++)
     result += v[i] * v[i];
 
@@ -467,6 +637,7 @@ scalarproduct(CCTK_REAL *v, CCTK_REAL *w, int n) {
   int i;
   CCTK_REAL result = 0;
 
+#pragma omp parallel for reduction(+ : result)
   for (i = 0; i < n; i++)
     result += v[i] * w[i];
 
@@ -168,14 +168,320 @@ static void set_initial_guess(CCTK_POINTER_TO_CONST cctkGH, derivs v) {
 }
 
 /* -------------------------------------------------------------------*/
-void TwoPunctures(CCTK_ARGUMENTS);
-void TwoPunctures(CCTK_ARGUMENTS) {
-  DECLARE_CCTK_ARGUMENTS_TwoPunctures;
+/* Iteratively solve for the bare masses mp and mm, given the target ADM
+   masses target_M_plus and target_M_minus and with initial guesses given
+   by mp and mm, solving for v at each step */
+static void find_bare_masses(CCTK_POINTER_TO_CONST cctkGH, int nvar, int n1,
+                             int n2, int n3, derivs v, CCTK_REAL *mp,
+                             CCTK_REAL *mm, CCTK_REAL *mp_adm,
+                             CCTK_REAL *mm_adm) {
   DECLARE_CCTK_PARAMETERS;
+  int const ntotal = n1 * n2 * n3 * nvar;
+  CCTK_REAL *F, up, um, tmp, mp_adm_err, mm_adm_err;
+  derivs u;
+  char valbuf[100];
+
+  F = dvector(0, ntotal - 1);
+  allocate_derivs(&u, ntotal);
+
+  CCTK_REAL M_p = target_M_plus;
+  CCTK_REAL M_m = target_M_minus;
+
+  CCTK_VINFO("Attempting to find bare masses.");
+  CCTK_VINFO("Target ADM masses: M_p=%g and M_m=%g", (double)M_p, (double)M_m);
+  CCTK_VINFO("ADM mass tolerance: %g", (double)adm_tol);
+
+  /* Loop until both ADM masses are within adm_tol of their target */
+  do {
+    CCTK_VINFO("Bare masses: mp=%.15g, mm=%.15g", (double)*mp, (double)*mm);
+    Newton(cctkGH, nvar, n1, n2, n3, v, Newton_tol, 1);
+
+    F_of_v(cctkGH, nvar, n1, n2, n3, v, F, u);
+
+    up = PunctIntPolAtArbitPosition(0, nvar, n1, n2, n3, v, par_b, 0., 0.);
+    um = PunctIntPolAtArbitPosition(0, nvar, n1, n2, n3, v, -par_b, 0., 0.);
+
+    /* Calculate the ADM masses from the current bare mass guess */
+    *mp_adm = (1 + up) * *mp + *mp * *mm / (4. * par_b);
+    *mm_adm = (1 + um) * *mm + *mp * *mm / (4. * par_b);
+
+    /* Check how far the current ADM masses are from the target */
+    mp_adm_err = fabs(M_p - *mp_adm);
+    mm_adm_err = fabs(M_m - *mm_adm);
+    CCTK_VINFO("ADM mass error: M_p_err=%.15g, M_m_err=%.15g",
+               (double)mp_adm_err, (double)mm_adm_err);
+
+    /* Invert the ADM mass equation and update the bare mass guess so that
+       it gives the correct target ADM masses */
+    tmp = -4 * par_b * (1 + um + up + um * up) +
+          sqrt(16 * par_b * M_m * (1 + um) * (1 + up) +
+               pow(-M_m + M_p + 4 * par_b * (1 + um) * (1 + up), 2));
+    *mp = (tmp + M_p - M_m) / (2. * (1 + up));
+    *mm = (tmp - M_p + M_m) / (2. * (1 + um));
+
+    /* Set the par_m_plus and par_m_minus parameters */
+    sprintf(valbuf, "%.17g", (double)*mp);
+    CCTK_ParameterSet("par_m_plus", "TwoPunctures", valbuf);
+
+    sprintf(valbuf, "%.17g", (double)*mm);
+    CCTK_ParameterSet("par_m_minus", "TwoPunctures", valbuf);
+
+  } while ((mp_adm_err > adm_tol) || (mm_adm_err > adm_tol));
+
+  CCTK_VINFO("Found bare masses.");
+
+  free_dvector(F, 0, ntotal - 1);
+  free_derivs(&u, ntotal);
+}
+
+/* -------------------------------------------------------------------*/
+/* Solve on up to grid_sequencing_levels spectral grids that are coarser
+   than n1 x n2 x n3 by factors of 2, 4, ..., from the coarsest to the
+   finest, each starting from the solution on the previous one. The last
+   solution is prolonged into v as initial guess on the full grid. */
+static void solve_coarse_grids(CCTK_POINTER_TO_CONST cctkGH, int nvar, int n1,
+                               int n2, int n3, derivs v, CCTK_REAL *mp,
+                               CCTK_REAL *mm, CCTK_REAL *mp_adm,
+                               CCTK_REAL *mm_adm) {
+  DECLARE_CCTK_PARAMETERS;
+  int m1 = 0, m2 = 0, m3 = 0, mtotal = 0;
+  CCTK_REAL *cf = NULL;
+
+  for (int level = grid_sequencing_levels; level >= 1; level--) {
+    /* There must be at least 4 points in each direction, and an even
+       number in the phi direction */
+    int const l1 = maximum2(4, n1 >> level), l2 = maximum2(4, n2 >> level),
+              l3 = maximum2(4, 2 * (n3 >> (level + 1)));
+    int const ltotal = nvar * l1 * l2 * l3;
+    derivs w;
+
+    if ((l1 == m1 && l2 == m2 && l3 == m3) ||
+        (l1 == n1 && l2 == n2 && l3 == n3))
+      continue;
+
+    CCTK_VINFO("Solving on the coarser spectral grid %d x %d x %d", l1, l2,
+               l3);
+    allocate_derivs(&w, ltotal);
+    if (cf) {
+      SpecProlong(m1, m2, m3, 0, cf, l1, l2, l3, w.d0);
+      free_dvector(cf, 0, mtotal - 1);
+    } else {
+      for (int j = 0; j < ltotal; j++)
+        w.d0[j] = 0.0;
+    }
+
+    if (!give_bare_mass) {
+      find_bare_masses(cctkGH, nvar, l1, l2, l3, w, mp, mm, mp_adm, mm_adm);
+    }
+    Newton(cctkGH, nvar, l1, l2, l3, w, Newton_tol, Newton_maxit);
+
+    cf = dvector(0, ltotal - 1);
+    SpecCoef(l1, l2, l3, 0, w.d0, cf);
+    free_derivs(&w, ltotal);
+    m1 = l1;
+    m2 = l2;
+    m3 = l3;
+    mtotal = ltotal;
+  }
+
+  if (cf) {
+    SpecProlong(m1, m2, m3, 0, cf, n1, n2, n3, v.d0);
+    free_dvector(cf, 0, mtotal - 1);
+  }
+}
+
+/* -------------------------------------------------------------------*/
+/* The spectral solution and the scalars derived from it, computed once
+   by TwoPunctures_Solve and used by all calls of TwoPunctures */
+static bool did_solve = false;
+static derivs v, cf_v;
+static CCTK_REAL mp_saved, mm_saved, mp_adm_saved, mm_adm_saved, E_saved,
+    J1_saved, J2_saved, J3_saved;
+
+/* Solve the puncture equation. This runs in global mode, i.e. not from
+   the threaded loop over the tiles, so that the OpenMP parallel regions
+   of the solver get all threads. */
+void TwoPunctures_Solve(CCTK_ARGUMENTS);
+void TwoPunctures_Solve(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTS_TwoPunctures_Solve;
+  DECLARE_CCTK_PARAMETERS;
+
+  int const nvar = 1, n1 = npoints_A, n2 = npoints_B, n3 = npoints_phi;
+
+  int const ntotal = n1 * n2 * n3 * nvar;
+
+  /* Solve only when called for the first time */
+  if (did_solve)
+    return;
 
   *mp = par_m_plus;
   *mm = par_m_minus;
 
+  CCTK_REAL up, um, admMass;
+  CCTK_REAL *const F = dvector(0, ntotal - 1);
+  derivs u;
+  allocate_derivs(&u, ntotal);
+  allocate_derivs(&v, ntotal);
+  allocate_derivs(&cf_v, ntotal);
+
+  if (use_sources) {
+    CCTK_INFO("Solving puncture equation for BH-NS/NS-NS system");
+  } else {
+    CCTK_INFO("Solving puncture equation for BH-BH system");
+  }
+  CCTK_VINFO("b = %g", par_b);
+
+  /* initialise to 0 */
+  for (int j = 0; j < ntotal; j++) {
+    cf_v.d0[j] = 0.0;
+    cf_v.d1[j] = 0.0;
+    cf_v.d2[j] = 0.0;
+    cf_v.d3[j] = 0.0;
+    cf_v.d11[j] = 0.0;
+    cf_v.d12[j] = 0.0;
+    cf_v.d13[j] = 0.0;
+    cf_v.d22[j] = 0.0;
+    cf_v.d23[j] = 0.0;
+    cf_v.d33[j] = 0.0;
+    v.d0[j] = 0.0;
+    v.d1[j] = 0.0;
+    v.d2[j] = 0.0;
+    v.d3[j] = 0.0;
+    v.d11[j] = 0.0;
+    v.d12[j] = 0.0;
+    v.d13[j] = 0.0;
+    v.d22[j] = 0.0;
+    v.d23[j] = 0.0;
+    v.d33[j] = 0.0;
+  }
+  /* call for external initial guess */
+  if (use_external_initial_guess) {
+    set_initial_guess(cctkGH, v);
+  }
+
+  /* A cached solution for the same parameters replaces the solve,
+     and one for nearby parameters is a better initial guess */
+  bool const have_solution =
+      use_solution_cache &&
+      Cache_ReadSolution(nvar, n1, n2, n3, v, cf_v, mp, mm);
+  bool have_guess = use_external_initial_guess;
+  if (use_solution_cache && !have_solution && !have_guess) {
+    have_guess = Cache_GuessSolution(nvar, n1, n2, n3, v, mp, mm);
+  }
+
+  /* Otherwise, solve on coarser spectral grids first, so that most
+     Newton iterations happen there */
+  if (grid_sequencing_levels > 0 && !have_solution && !have_guess) {
+    solve_coarse_grids(cctkGH, nvar, n1, n2, n3, v, mp, mm, mp_adm, mm_adm);
+  }
+
+  if (benchmark_solver && !have_solution) {
+    Newton_benchmark(cctkGH, nvar, n1, n2, n3, v, Newton_tol,
+                     Newton_maxit);
+  }
+
+  /* If bare masses are not given, iteratively solve for them given the
+     target ADM masses target_M_plus and target_M_minus and with initial
+     guesses given by par_m_plus and par_m_minus. */
+  if (!(give_bare_mass) && !have_solution) {
+    find_bare_masses(cctkGH, nvar, n1, n2, n3, v, mp, mm, mp_adm, mm_adm);
+  }
+
+  if (!have_solution) {
+    Newton(cctkGH, nvar, n1, n2, n3, v, Newton_tol, Newton_maxit);
+  }
+
+  F_of_v(cctkGH, nvar, n1, n2, n3, v, F, u);
+  free_dvector(F, 0, ntotal - 1);
+  free_derivs(&u, ntotal);
+
+  if (!have_solution) {
+    SpecCoef(n1, n2, n3, 0, v.d0, cf_v.d0);
+  }
+
+  CCTK_VINFO("The two puncture masses are mp=%.17g and mm=%.17g",
+             (double)*mp, (double)*mm);
+
+  up = PunctIntPolAtArbitPosition(0, nvar, n1, n2, n3, v, par_b, 0., 0.);
+  um = PunctIntPolAtArbitPosition(0, nvar, n1, n2, n3, v, -par_b, 0., 0.);
+
+  /* Calculate the ADM masses from the current bare mass guess */
+  *mp_adm = (1 + up) * *mp + *mp * *mm / (4. * par_b);
+  *mm_adm = (1 + um) * *mm + *mp * *mm / (4. * par_b);
+
+  CCTK_VINFO("Puncture 1 ADM mass is %g", (double)*mp_adm);
+  CCTK_VINFO("Puncture 2 ADM mass is %g", (double)*mm_adm);
+
+  /* print out ADM mass, eq.: \Delta M_ADM=2*r*u=4*b*V for A=1,B=0,phi=0 */
+  admMass =
+      (*mp + *mm -
+       4 * par_b *
+           PunctEvalAtArbitPosition(v.d0, 0, 1, 0, 0, nvar, n1, n2, n3));
+  CCTK_VINFO("The total ADM mass is %g", (double)admMass);
+  *E = admMass;
+
+  /*
+    Run this in Mathematica (version 8 or later) with
+      math -script <file>
+
+    Needs["SymbolicC`"];
+    co = Table["center_offset[" <> ToString[i] <> "]", {i, 0, 2}];
+    r1 = co + {"par_b", 0, 0};
+    r2 = co + {-"par_b", 0, 0};
+    {p1, p2} = Table["par_P_" <> bh <> "[" <> ToString[i] <> "]", {bh,
+    {"plus", "minus"}}, {i, 0, 2}]; {s1, s2} = Table["par_S_" <> bh <> "["
+    <> ToString[i] <> "]", {bh, {"plus", "minus"}}, {i, 0, 2}];
+
+    J = Cross[r1, p1] + Cross[r2, p2] + s1 + s2;
+
+    JVar = Table["*J" <> ToString[i], {i, 1, 3}];
+    Print[OutputForm@StringReplace[
+      ToCCodeString@MapThread[CAssign[#1, CExpression[#2]] &, {JVar, J}],
+      "\"" -> ""]];
+   */
+
+  *J1 = -(center_offset[2] * par_P_minus[1]) +
+        center_offset[1] * par_P_minus[2] -
+        center_offset[2] * par_P_plus[1] +
+        center_offset[1] * par_P_plus[2] + par_S_minus[0] + par_S_plus[0];
+  *J2 = center_offset[2] * par_P_minus[0] -
+        center_offset[0] * par_P_minus[2] + par_b * par_P_minus[2] +
+        center_offset[2] * par_P_plus[0] -
+        center_offset[0] * par_P_plus[2] - par_b * par_P_plus[2] +
+        par_S_minus[1] + par_S_plus[1];
+  *J3 = -(center_offset[1] * par_P_minus[0]) +
+        center_offset[0] * par_P_minus[1] - par_b * par_P_minus[1] -
+        center_offset[1] * par_P_plus[0] +
+        center_offset[0] * par_P_plus[1] + par_b * par_P_plus[1] +
+        par_S_minus[2] + par_S_plus[2];
+
+  // store these in local variables so that we can restore them once CarpetX
+  // can wipes the grid scalars
+  mp_saved = *mp;
+  mm_saved = *mm;
+  mp_adm_saved = *mp_adm;
+  mm_adm_saved = *mm_adm;
+  E_saved = *E;
+  J1_saved = *J1;
+  J2_saved = *J2;
+  J3_saved = *J3;
+
+  /* Every process solved, so that process 0 can add the solution to the
+     cache even if it owns no tiles */
+  if (use_solution_cache && !have_solution) {
+    Cache_WriteSolution(cctkGH, nvar, n1, n2, n3, v, cf_v, mp_saved,
+                        mm_saved, mp_adm_saved, mm_adm_saved, E_saved);
+  }
+
+  did_solve = true;
+}
+
+/* -------------------------------------------------------------------*/
+void TwoPunctures(CCTK_ARGUMENTS);
+void TwoPunctures(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTS_TwoPunctures;
+  DECLARE_CCTK_PARAMETERS;
+
   enum GRID_SETUP_METHOD { GSM_Taylor_expansion, GSM_evaluation };
   enum GRID_SETUP_METHOD gsm;
 
@@ -183,196 +489,11 @@ void TwoPunctures(CCTK_ARGUMENTS) {
 
   int const nvar = 1, n1 = npoints_A, n2 = npoints_B, n3 = npoints_phi;
 
-  int const ntotal = n1 * n2 * n3 * nvar;
 #if 0
   int percent10 = 0;
 #endif
-  static bool did_setup = false;
-  static CCTK_REAL *F = NULL;
-  static derivs u, v, cf_v;
-  static CCTK_REAL mp_saved, mm_saved, mp_adm_saved, mm_adm_saved, E_saved,
-      J1_saved, J2_saved, J3_saved;
-  CCTK_REAL admMass;
-
-  if (!did_setup) {
-#pragma omp critical
-    if (!did_setup) {
-      CCTK_REAL up, um;
-      /* Solve only when called for the first time */
-      F = dvector(0, ntotal - 1);
-      allocate_derivs(&u, ntotal);
-      allocate_derivs(&v, ntotal);
-      allocate_derivs(&cf_v, ntotal);
-
-      if (use_sources) {
-        CCTK_INFO("Solving puncture equation for BH-NS/NS-NS system");
-      } else {
-        CCTK_INFO("Solving puncture equation for BH-BH system");
-      }
-      CCTK_VINFO("b = %g", par_b);
-
-      /* initialise to 0 */
-      for (int j = 0; j < ntotal; j++) {
-        cf_v.d0[j] = 0.0;
-        cf_v.d1[j] = 0.0;
-        cf_v.d2[j] = 0.0;
-        cf_v.d3[j] = 0.0;
-        cf_v.d11[j] = 0.0;
-        cf_v.d12[j] = 0.0;
-        cf_v.d13[j] = 0.0;
-        cf_v.d22[j] = 0.0;
-        cf_v.d23[j] = 0.0;
-        cf_v.d33[j] = 0.0;
-        v.d0[j] = 0.0;
-        v.d1[j] = 0.0;
-        v.d2[j] = 0.0;
-        v.d3[j] = 0.0;
-        v.d11[j] = 0.0;
-        v.d12[j] = 0.0;
-        v.d13[j] = 0.0;
-        v.d22[j] = 0.0;
-        v.d23[j] = 0.0;
-        v.d33[j] = 0.0;
-      }
-      /* call for external initial guess */
-      if (use_external_initial_guess) {
-        set_initial_guess(cctkGH, v);
-      }
-
-      /* If bare masses are not given, iteratively solve for them given the
-         target ADM masses target_M_plus and target_M_minus and with initial
-         guesses given by par_m_plus and par_m_minus. */
-      if (!(give_bare_mass)) {
-        CCTK_REAL tmp, mp_adm_err, mm_adm_err;
-        char valbuf[100];
-
-        CCTK_REAL M_p = target_M_plus;
-        CCTK_REAL M_m = target_M_minus;
-
-        CCTK_VINFO("Attempting to find bare masses.");
-        CCTK_VINFO("Target ADM masses: M_p=%g and M_m=%g", (double)M_p,
-                   (double)M_m);
-        CCTK_VINFO("ADM mass tolerance: %g", (double)adm_tol);
-
-        /* Loop until both ADM masses are within adm_tol of their target */
-        do {
-          CCTK_VINFO("Bare masses: mp=%.15g, mm=%.15g", (double)*mp,
-                     (double)*mm);
-          Newton(cctkGH, nvar, n1, n2, n3, v, Newton_tol, 1);
-
-          F_of_v(cctkGH, nvar, n1, n2, n3, v, F, u);
-
-          up =
-              PunctIntPolAtArbitPosition(0, nvar, n1, n2, n3, v, par_b, 0., 0.);
-          um = PunctIntPolAtArbitPosition(0, nvar, n1, n2, n3, v, -par_b, 0.,
-                                          0.);
-
-          /* Calculate the ADM masses from the current bare mass guess */
-          *mp_adm = (1 + up) * *mp + *mp * *mm / (4. * par_b);
-          *mm_adm = (1 + um) * *mm + *mp * *mm / (4. * par_b);
-
-          /* Check how far the current ADM masses are from the target */
-          mp_adm_err = fabs(M_p - *mp_adm);
-          mm_adm_err = fabs(M_m - *mm_adm);
-          CCTK_VINFO("ADM mass error: M_p_err=%.15g, M_m_err=%.15g",
-                     (double)mp_adm_err, (double)mm_adm_err);
-
-          /* Invert the ADM mass equation and update the bare mass guess so that
-             it gives the correct target ADM masses */
-          tmp = -4 * par_b * (1 + um + up + um * up) +
-                sqrt(16 * par_b * M_m * (1 + um) * (1 + up) +
-                     pow(-M_m + M_p + 4 * par_b * (1 + um) * (1 + up), 2));
-          *mp = (tmp + M_p - M_m) / (2. * (1 + up));
-          *mm = (tmp - M_p + M_m) / (2. * (1 + um));
-
-          /* Set the par_m_plus and par_m_minus parameters */
-          sprintf(valbuf, "%.17g", (double)*mp);
-          CCTK_ParameterSet("par_m_plus", "TwoPunctures", valbuf);
-
-          sprintf(valbuf, "%.17g", (double)*mm);
-          CCTK_ParameterSet("par_m_minus", "TwoPunctures", valbuf);
-
-        } while ((mp_adm_err > adm_tol) || (mm_adm_err > adm_tol));
-
-        CCTK_VINFO("Found bare masses.");
-      }
 
-      Newton(cctkGH, nvar, n1, n2, n3, v, Newton_tol, Newton_maxit);
-
-      F_of_v(cctkGH, nvar, n1, n2, n3, v, F, u);
-
-      SpecCoef(n1, n2, n3, 0, v.d0, cf_v.d0);
-
-      CCTK_VINFO("The two puncture masses are mp=%.17g and mm=%.17g",
-                 (double)*mp, (double)*mm);
-
-      up = PunctIntPolAtArbitPosition(0, nvar, n1, n2, n3, v, par_b, 0., 0.);
-      um = PunctIntPolAtArbitPosition(0, nvar, n1, n2, n3, v, -par_b, 0., 0.);
-
-      /* Calculate the ADM masses from the current bare mass guess */
-      *mp_adm = (1 + up) * *mp + *mp * *mm / (4. * par_b);
-      *mm_adm = (1 + um) * *mm + *mp * *mm / (4. * par_b);
-
-      CCTK_VINFO("Puncture 1 ADM mass is %g", (double)*mp_adm);
-      CCTK_VINFO("Puncture 2 ADM mass is %g", (double)*mm_adm);
-
-      /* print out ADM mass, eq.: \Delta M_ADM=2*r*u=4*b*V for A=1,B=0,phi=0 */
-      admMass =
-          (*mp + *mm -
-           4 * par_b *
-               PunctEvalAtArbitPosition(v.d0, 0, 1, 0, 0, nvar, n1, n2, n3));
-      CCTK_VINFO("The total ADM mass is %g", (double)admMass);
-      *E = admMass;
-
-      /*
-        Run this in Mathematica (version 8 or later) with
-          math -script <file>
-
-        Needs["SymbolicC`"];
-        co = Table["center_offset[" <> ToString[i] <> "]", {i, 0, 2}];
-        r1 = co + {"par_b", 0, 0};
-        r2 = co + {-"par_b", 0, 0};
-        {p1, p2} = Table["par_P_" <> bh <> "[" <> ToString[i] <> "]", {bh,
-        {"plus", "minus"}}, {i, 0, 2}]; {s1, s2} = Table["par_S_" <> bh <> "["
-        <> ToString[i] <> "]", {bh, {"plus", "minus"}}, {i, 0, 2}];
-
-        J = Cross[r1, p1] + Cross[r2, p2] + s1 + s2;
-
-        JVar = Table["*J" <> ToString[i], {i, 1, 3}];
-        Print[OutputForm@StringReplace[
-          ToCCodeString@MapThread[CAssign[#1, CExpression[#2]] &, {JVar, J}],
-          "\"" -> ""]];
-       */
-
-      *J1 = -(center_offset[2] * par_P_minus[1]) +
-            center_offset[1] * par_P_minus[2] -
-            center_offset[2] * par_P_plus[1] +
-            center_offset[1] * par_P_plus[2] + par_S_minus[0] + par_S_plus[0];
-      *J2 = center_offset[2] * par_P_minus[0] -
-            center_offset[0] * par_P_minus[2] + par_b * par_P_minus[2] +
-            center_offset[2] * par_P_plus[0] -
-            center_offset[0] * par_P_plus[2] - par_b * par_P_plus[2] +
-            par_S_minus[1] + par_S_plus[1];
-      *J3 = -(center_offset[1] * par_P_minus[0]) +
-            center_offset[0] * par_P_minus[1] - par_b * par_P_minus[1] -
-            center_offset[1] * par_P_plus[0] +
-            center_offset[0] * par_P_plus[1] + par_b * par_P_plus[1] +
-            par_S_minus[2] + par_S_plus[2];
-
-      // store these in local variables so that we can restore them once CarpetX
-      // can wipes the grid scalars
-      mp_saved = *mp;
-      mm_saved = *mm;
-      mp_adm_saved = *mp_adm;
-      mm_adm_saved = *mm_adm;
-      E_saved = *E;
-      J1_saved = *J1;
-      J2_saved = *J2;
-      J3_saved = *J3;
-
-      did_setup = true;
-    }
-  }
+  assert(did_solve);
 
   // before each call CarpetX wipes the grid scalars so I need to restore them
   *mp = mp_saved;
@@ -415,6 +536,33 @@ void TwoPunctures(CCTK_ARGUMENTS) {
   const int dj = di * cctk_ash[0];
   const int dk = dj * cctk_ash[1];
   const int np = dk * cctk_ash[2];
+
+  /* When evaluating the spectral series, evaluate it for all points of
+     the grid at once, which is much faster than point by point */
+  CCTK_REAL *Ugrid = NULL;
+  if (gsm == GSM_evaluation) {
+    const int npoints = cctk_lsh[0] * cctk_lsh[1] * cctk_lsh[2];
+    CCTK_REAL *const xgrid = malloc(sizeof *xgrid * npoints);
+    CCTK_REAL *const ygrid = malloc(sizeof *ygrid * npoints);
+    CCTK_REAL *const zgrid = malloc(sizeof *zgrid * npoints);
+    Ugrid = malloc(sizeof *Ugrid * npoints);
+    CCTK_LOOP3_ALL(TwoPunctures_coords, cctkGH, i, j, k) {
+      const int ind = CCTK_GFINDEX3D(cctkGH, i, j, k);
+      const int n = i + cctk_lsh[0] * (j + cctk_lsh[1] * k);
+      xgrid[n] = vcoordx[ind] - center_offset[0];
+      ygrid[n] = vcoordy[ind] - center_offset[1];
+      zgrid[n] = vcoordz[ind] - center_offset[2];
+      if (swap_xz)
+        SWAP(xgrid[n], zgrid[n]);
+    }
+    CCTK_ENDLOOP3_ALL(TwoPunctures_coords);
+    PunctIntPolAtArbitPositionBatch(0, nvar, n1, n2, n3, cf_v, npoints, xgrid,
+                                    ygrid, zgrid, Ugrid);
+    free(zgrid);
+    free(ygrid);
+    free(xgrid);
+  }
+
   CCTK_LOOP3_ALL(TwoPunctures, cctkGH, i, j, k) {
 
     const int ind = CCTK_GFINDEX3D(cctkGH, i, j, k);
@@ -444,7 +592,7 @@ void TwoPunctures(CCTK_ARGUMENTS) {
       U = PunctTaylorExpandAtArbitPosition(0, nvar, n1, n2, n3, v, xx, yy, zz);
       break;
     case GSM_evaluation:
-      U = PunctIntPolAtArbitPositionFast(0, nvar, n1, n2, n3, cf_v, xx, yy, zz);
+      U = Ugrid[i + cctk_lsh[0] * (j + cctk_lsh[1] * k)];
       break;
     default:
       assert(0);
@@ -599,6 +747,7 @@ void TwoPunctures(CCTK_ARGUMENTS) {
     } /* if swap_xz */
   }
   CCTK_ENDLOOP3_ALL(TwoPunctures);
+  free(Ugrid);
 
   if (use_sources && rescale_sources) {
     assert(0); // TODO: Implement via critical region
@@ -12,6 +12,7 @@ typedef struct DERIVS {
 /*
 Files of "TwoPunctures":
         TwoPunctures.c
+        Cache.c
         FuncAndJacobian.c
         CoordTransf.c
         Equations.c
@@ -52,12 +53,18 @@ CCTK_REAL PunctIntPolAtArbitPosition(int ivar, int nvar, int n1, int n2, int n3,
                                      derivs v, CCTK_REAL x, CCTK_REAL y,
                                      CCTK_REAL z);
 void SpecCoef(int n1, int n2, int n3, int ivar, CCTK_REAL *v, CCTK_REAL *cf);
+void SpecProlong(int n1, int n2, int n3, int ivar, CCTK_REAL *cf, int m1,
+                 int m2, int m3, CCTK_REAL *v);
 CCTK_REAL PunctEvalAtArbitPositionFast(CCTK_REAL *v, int ivar, CCTK_REAL A,
                                        CCTK_REAL B, CCTK_REAL phi, int nvar,
                                        int n1, int n2, int n3);
 CCTK_REAL PunctIntPolAtArbitPositionFast(int ivar, int nvar, int n1, int n2,
                                          int n3, derivs v, CCTK_REAL x,
                                          CCTK_REAL y, CCTK_REAL z);
+void PunctIntPolAtArbitPositionBatch(int ivar, int nvar, int n1, int n2,
+                                     int n3, derivs v, int npoints,
+                                     CCTK_REAL const *x, CCTK_REAL const *y,
+                                     CCTK_REAL const *z, CCTK_REAL *U);
 
 /* Routines in  "CoordTransf.c"*/
 void AB_To_XR(int nvar, CCTK_REAL A, CCTK_REAL B, CCTK_REAL *X, CCTK_REAL *R,
@@ -77,11 +84,23 @@ void LinEquations(CCTK_REAL A, CCTK_REAL B, CCTK_REAL X, CCTK_REAL R,
                   CCTK_REAL x, CCTK_REAL r, CCTK_REAL phi, CCTK_REAL y,
                   CCTK_REAL z, derivs dU, derivs U, CCTK_REAL *values);
 
+/* Routines in  "Cache.c"*/
+int Cache_ReadSolution(int nvar, int n1, int n2, int n3, derivs v,
+                       derivs cf_v, CCTK_REAL *mp, CCTK_REAL *mm);
+int Cache_GuessSolution(int nvar, int n1, int n2, int n3, derivs v,
+                        CCTK_REAL *mp, CCTK_REAL *mm);
+void Cache_WriteSolution(CCTK_POINTER_TO_CONST cctkGH, int nvar, int n1,
+                         int n2, int n3, derivs v, derivs cf_v, CCTK_REAL mp,
+                         CCTK_REAL mm, CCTK_REAL mp_adm, CCTK_REAL mm_adm,
+                         CCTK_REAL E);
+
 /* Routines in  "Newton.c"*/
 void TestRelax(CCTK_POINTER_TO_CONST cctkGH, int nvar, int n1, int n2, int n3,
                derivs v, CCTK_REAL *dv);
 void Newton(CCTK_POINTER_TO_CONST cctkGH, int nvar, int n1, int n2, int n3,
             derivs v, CCTK_REAL tol, int itmax);
+void Newton_benchmark(CCTK_POINTER_TO_CONST cctkGH, int nvar, int n1, int n2,
+                      int n3, derivs v, CCTK_REAL tol, int itmax);
 
 /*
  27: -1.325691774825335e-03
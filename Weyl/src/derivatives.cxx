@@ -0,0 +1,73 @@
+#include "weyl.hxx"
+
+#include "derivs.hxx"
+
+#include <cctk_Parameters.h>
+
+namespace Weyl {
+
+template <int deriv_order> void gfs_t::calc_derivatives() const {
+  typedef simd<CCTK_REAL> vreal;
+  typedef simdl<CCTK_REAL> vbool;
+  constexpr std::size_t vsize = std::tuple_size_v<vreal>;
+
+  const vec<CCTK_REAL, dim> dx(
+      [&](int a) { return cctkGH->cctk_delta_space[a]; });
+
+  // Calculate all derivatives in a single sweep
+  grid.loop_int_device<0, 0, 0, vsize>(
+      grid.nghostzones,
+      [layout0 = layout0, dx = dx, //
+       gf_alpha1 = gf_alpha1, gf_beta1 = gf_beta1, gf_gamma1 = gf_gamma1,
+       gf_K1 = gf_K1, gf_dtalpha1 = gf_dtalpha1,
+       gf_dtbeta1 = gf_dtbeta1, //
+       gf_alpha0 = gf_alpha0, gf_dalpha0 = gf_dalpha0,
+       gf_ddalpha0 = gf_ddalpha0, gf_beta0 = gf_beta0, gf_dbeta0 = gf_dbeta0,
+       gf_ddbeta0 = gf_ddbeta0, gf_gamma0 = gf_gamma0,
+       gf_dgamma0 = gf_dgamma0, gf_ddgamma0 = gf_ddgamma0, gf_K0 = gf_K0,
+       gf_dK0 = gf_dK0, gf_dtalpha0 = gf_dtalpha0,
+       gf_ddtalpha0 = gf_ddtalpha0, gf_dtbeta0 = gf_dtbeta0,
+       gf_ddtbeta0 = gf_ddtbeta0 //
+  ] ARITH_DEVICE(const PointDesc &p) ARITH_INLINE {
+        const vbool mask = mask_for_loop_tail<vbool>(p.i, p.imax);
+        const int vavail = p.imax - p.i;
+        const GF3D5index index0(layout0, p.I);
+
+        store_derivs2<deriv_order>(vavail, mask, p.I, index0, dx, gf_alpha1,
+                                   gf_alpha0, gf_dalpha0, gf_ddalpha0);
+        store_derivs2<deriv_order>(vavail, mask, p.I, index0, dx, gf_beta1,
+                                   gf_beta0, gf_dbeta0, gf_ddbeta0);
+        store_derivs2<deriv_order>(vavail, mask, p.I, index0, dx, gf_gamma1,
+                                   gf_gamma0, gf_dgamma0, gf_ddgamma0);
+        store_derivs<deriv_order>(mask, p.I, index0, dx, gf_K1, gf_K0,
+                                  gf_dK0);
+
+        store_derivs<deriv_order>(mask, p.I, index0, dx, gf_dtalpha1,
+                                  gf_dtalpha0, gf_ddtalpha0);
+        store_derivs<deriv_order>(mask, p.I, index0, dx, gf_dtbeta1,
+                                  gf_dtbeta0, gf_ddtbeta0);
+      });
+}
+
+void gfs_t::calc_derivatives() const {
+  DECLARE_CCTK_PARAMETERS;
+
+  switch (deriv_order) {
+  case 2:
+    calc_derivatives<2>();
+    break;
+  case 4:
+    calc_derivatives<4>();
+    break;
+  case 6:
+    calc_derivatives<6>();
+    break;
+  case 8:
+    calc_derivatives<8>();
+    break;
+  default:
+    CCTK_VERROR("Unsupported derivative order %d", int(deriv_order));
+  }
+}
+
+} // namespace Weyl
@@ -1,5 +1,5 @@
-#ifndef DERIVS_HXX
-#define DERIVS_HXX
+#ifndef WEYL_DERIVS_HXX
+#define WEYL_DERIVS_HXX
 
 #include <div.hxx>
 #include <loop_device.hxx>
@@ -26,7 +26,9 @@ using namespace std;
 
 ////////////////////////////////////////////////////////////////////////////////
 
-constexpr int deriv_order = 4;
+// The finite differencing order `deriv_order` is a template parameter
+// of all stencils. It is chosen at run time (see parameter
+// `Weyl::deriv_order`) by dispatching to the respective instantiation.
 
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -37,10 +39,12 @@ inline ARITH_INLINE ARITH_DEVICE ARITH_HOST T pow3(const T &x) {
 
 ////////////////////////////////////////////////////////////////////////////////
 
-template <typename T>
+template <int deriv_order, typename T>
 inline ARITH_INLINE ARITH_DEVICE ARITH_HOST simd<T>
 deriv1d(const simdl<T> &mask, const T *restrict const var, const ptrdiff_t di,
         const T dx) {
+  static_assert(deriv_order >= 2 && deriv_order <= 8 && deriv_order % 2 == 0,
+                "");
   const auto load = [&](const int n) {
     return maskz_loadu(mask, &var[n * di]) - maskz_loadu(mask, &var[-n * di]);
   };
@@ -51,12 +55,18 @@ deriv1d(const simdl<T> &mask, const T *restrict const var, const ptrdiff_t di,
   if constexpr (deriv_order == 6)
     return (1 / T(60) * load(3) - 3 / T(20) * load(2) + 3 / T(4) * load(1)) /
            dx;
+  if constexpr (deriv_order == 8)
+    return (-1 / T(280) * load(4) + 4 / T(105) * load(3) -
+            1 / T(5) * load(2) + 4 / T(5) * load(1)) /
+           dx;
 }
 
-template <typename T>
+template <int deriv_order, typename T>
 inline ARITH_INLINE ARITH_DEVICE ARITH_HOST simd<T>
 deriv2_1d(const simdl<T> &mask, const T *restrict const var, const ptrdiff_t di,
           const T dx) {
+  static_assert(deriv_order >= 2 && deriv_order <= 8 && deriv_order % 2 == 0,
+                "");
   const auto load = [&](const int n) {
     return maskz_loadu(mask, &var[n * di]) + maskz_loadu(mask, &var[-n * di]);
   };
@@ -64,18 +74,24 @@ deriv2_1d(const simdl<T> &mask, const T *restrict const var, const ptrdiff_t di,
   if constexpr (deriv_order == 2)
     return (load(1) - 2 * load0()) / pow2(dx);
   if constexpr (deriv_order == 4)
-    return (1 / T(12) * load(2) - 4 / T(3) * load(1) + 5 / T(2) * load0()) /
+    return (-1 / T(12) * load(2) + 4 / T(3) * load(1) - 5 / T(2) * load0()) /
            pow2(dx);
   if constexpr (deriv_order == 6)
     return (1 / T(90) * load(3) - 3 / T(20) * load(2) + 3 / T(2) * load(1) -
             49 / T(18) * load0()) /
            pow2(dx);
+  if constexpr (deriv_order == 8)
+    return (-1 / T(560) * load(4) + 8 / T(315) * load(3) -
+            1 / T(5) * load(2) + 8 / T(5) * load(1) - 205 / T(72) * load0()) /
+           pow2(dx);
 }
 
-template <typename T>
+template <int deriv_order, typename T>
 inline ARITH_INLINE ARITH_DEVICE ARITH_HOST simd<T>
 deriv3_1d(const simdl<T> &mask, const T *restrict const var, const ptrdiff_t di,
           const T dx) {
+  static_assert(deriv_order >= 2 && deriv_order <= 8 && deriv_order % 2 == 0,
+                "");
   const auto load = [&](const int n) {
     return maskz_loadu(mask, &var[n * di]) - maskz_loadu(mask, &var[-n * di]);
   };
@@ -85,11 +101,16 @@ deriv3_1d(const simdl<T> &mask, const T *restrict const var, const ptrdiff_t di,
     return (-1 / T(8) * load(3) + load(2) - 13 / T(8) * load(1)) / pow3(dx);
   if constexpr (deriv_order == 6)
     return (7 / T(240) * load(4) - 3 / T(10) * load(3) +
-            169 / T(129) * load(2) - 61 / T(30) * load(1)) /
+            169 / T(120) * load(2) - 61 / T(30) * load(1)) /
+           pow3(dx);
+  if constexpr (deriv_order == 8)
+    return (-41 / T(6048) * load(5) + 1261 / T(15120) * load(4) -
+            541 / T(1120) * load(3) + 4369 / T(2520) * load(2) -
+            1669 / T(720) * load(1)) /
            pow3(dx);
 }
 
-template <typename T>
+template <int deriv_order, typename T>
 inline ARITH_INLINE ARITH_DEVICE ARITH_HOST simd<T>
 deriv2_2d(const int vavail, const simdl<T> &mask, const T *restrict const var,
           const ptrdiff_t di, const ptrdiff_t dj, const T dx, const T dy) {
@@ -103,7 +124,7 @@ deriv2_2d(const int vavail, const simdl<T> &mask, const T *restrict const var,
       if (i < npoints) {
         const simdl<T> mask1 = mask_for_loop_tail<simdl<T> >(i, npoints);
         arrx[div_floor(i, int(vsize))] =
-            deriv1d(mask1, &var[i - deriv_order / 2], dj, dy);
+            deriv1d<deriv_order>(mask1, &var[i - deriv_order / 2], dj, dy);
       }
     }
 #ifdef CCTK_DEBUG
@@ -111,7 +132,7 @@ deriv2_2d(const int vavail, const simdl<T> &mask, const T *restrict const var,
       ((T *)&arrx[0])[i] = Arith::nan<T>()(); // unused
 #endif
     const T *const varx = (T *)&arrx[0] + deriv_order / 2;
-    return deriv1d(mask, varx, 1, dx);
+    return deriv1d<deriv_order>(mask, varx, 1, dx);
   } else {
     assert(dj != 1);
     array<simd<T>, deriv_order + 1> arrx;
@@ -121,26 +142,27 @@ deriv2_2d(const int vavail, const simdl<T> &mask, const T *restrict const var,
         arrx[deriv_order / 2 + j] = Arith::nan<simd<T> >()(); // unused
 #endif
       } else {
-        arrx[deriv_order / 2 + j] = deriv1d(mask, &var[j * dj], di, dx);
+        arrx[deriv_order / 2 + j] =
+            deriv1d<deriv_order>(mask, &var[j * dj], di, dx);
       }
     const T *const varx = (T *)(&arrx[deriv_order / 2]);
-    return deriv1d(mask, varx, vsize, dy);
+    return deriv1d<deriv_order>(mask, varx, vsize, dy);
   }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-template <int dir, typename T, int D>
+template <int deriv_order, int dir, typename T, int D>
 inline ARITH_INLINE ARITH_DEVICE ARITH_HOST simd<T>
 deriv(const simdl<T> &mask, const GF3D2<const T> &gf_, const vect<int, dim> &I,
       const vec<T, D> &dx) {
   static_assert(dir >= 0 && dir < D, "");
   const auto &DI = vect<int, dim>::unit;
   const ptrdiff_t di = gf_.delta(DI(dir));
-  return deriv1d(mask, &gf_(I), di, dx(dir));
+  return deriv1d<deriv_order>(mask, &gf_(I), di, dx(dir));
 }
 
-template <int dir1, int dir2, typename T, int D>
+template <int deriv_order, int dir1, int dir2, typename T, int D>
 inline ARITH_INLINE
     ARITH_DEVICE ARITH_HOST enable_if_t<(dir1 == dir2), simd<T> >
     deriv2(const int vavail, const simdl<T> &mask, const GF3D2<const T> &gf_,
@@ -149,10 +171,10 @@ inline ARITH_INLINE
   static_assert(dir2 >= 0 && dir2 < D, "");
   const auto &DI = vect<int, dim>::unit;
   const ptrdiff_t di = gf_.delta(DI(dir1));
-  return deriv2_1d(mask, &gf_(I), di, dx(dir1));
+  return deriv2_1d<deriv_order>(mask, &gf_(I), di, dx(dir1));
 }
 
-template <int dir1, int dir2, typename T, int D>
+template <int deriv_order, int dir1, int dir2, typename T, int D>
 inline ARITH_INLINE
     ARITH_DEVICE ARITH_HOST enable_if_t<(dir1 != dir2), simd<T> >
     deriv2(const int vavail, const simdl<T> &mask, const GF3D2<const T> &gf_,
@@ -162,10 +184,12 @@ inline ARITH_INLINE
   const auto &DI = vect<int, dim>::unit;
   const ptrdiff_t di = gf_.delta(DI(dir1));
   const ptrdiff_t dj = gf_.delta(DI(dir2));
-  return deriv2_2d(vavail, mask, &gf_(I), di, dj, dx(dir1), dx(dir2));
+  return deriv2_2d<deriv_order>(vavail, mask, &gf_(I), di, dj, dx(dir1),
+                                dx(dir2));
 }
 
-template <int dir1, int dir2, int dir3, typename T, int D>
+template <int deriv_order, int dir1, int dir2, int dir3, typename T,
+          int D>
 inline ARITH_INLINE ARITH_DEVICE ARITH_HOST
     enable_if_t<(dir1 == dir2 && dir1 == dir3), simd<T> >
     deriv3(const int vavail, const simdl<T> &mask, const GF3D2<const T> &gf_,
@@ -175,184 +199,127 @@ inline ARITH_INLINE ARITH_DEVICE ARITH_HOST
   static_assert(dir3 >= 0 && dir3 < D, "");
   const auto &DI = vect<int, dim>::unit;
   const ptrdiff_t di = gf_.delta(DI(dir1));
-  return deriv3_1d(mask, &gf_(I), di, dx(dir1));
+  return deriv3_1d<deriv_order>(mask, &gf_(I), di, dx(dir1));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-template <typename T>
+template <int deriv_order, typename T>
 inline ARITH_INLINE ARITH_DEVICE ARITH_HOST vec<simd<T>, dim>
 deriv(const simdl<T> &mask, const GF3D2<const T> &gf_, const vect<int, dim> &I,
       const vec<T, dim> &dx) {
-  return {deriv<0>(mask, gf_, I, dx), deriv<1>(mask, gf_, I, dx),
-          deriv<2>(mask, gf_, I, dx)};
+  return {deriv<deriv_order, 0>(mask, gf_, I, dx),
+          deriv<deriv_order, 1>(mask, gf_, I, dx),
+          deriv<deriv_order, 2>(mask, gf_, I, dx)};
 }
 
-template <typename T>
+template <int deriv_order, typename T>
 inline ARITH_INLINE ARITH_DEVICE ARITH_HOST smat<simd<T>, dim>
 deriv2(const int vavail, const simdl<T> &mask, const GF3D2<const T> &gf_,
        const vect<int, dim> &I, const vec<T, dim> &dx) {
-  return {deriv2<0, 0>(vavail, mask, gf_, I, dx),
-          deriv2<0, 1>(vavail, mask, gf_, I, dx),
-          deriv2<0, 2>(vavail, mask, gf_, I, dx),
-          deriv2<1, 1>(vavail, mask, gf_, I, dx),
-          deriv2<1, 2>(vavail, mask, gf_, I, dx),
-          deriv2<2, 2>(vavail, mask, gf_, I, dx)};
+  return {deriv2<deriv_order, 0, 0>(vavail, mask, gf_, I, dx),
+          deriv2<deriv_order, 0, 1>(vavail, mask, gf_, I, dx),
+          deriv2<deriv_order, 0, 2>(vavail, mask, gf_, I, dx),
+          deriv2<deriv_order, 1, 1>(vavail, mask, gf_, I, dx),
+          deriv2<deriv_order, 1, 2>(vavail, mask, gf_, I, dx),
+          deriv2<deriv_order, 2, 2>(vavail, mask, gf_, I, dx)};
 }
 
-template <typename T>
+template <int deriv_order, typename T>
 inline ARITH_INLINE ARITH_DEVICE ARITH_HOST sten3<simd<T>, dim>
 deriv3(const int vavail, const simdl<T> &mask, const GF3D2<const T> &gf_,
        const vect<int, dim> &I, const vec<T, dim> &dx) {
-  return {deriv3<0, 0, 0>(vavail, mask, gf_, I, dx),
-          deriv3<0, 0, 1>(vavail, mask, gf_, I, dx),
-          deriv3<0, 0, 2>(vavail, mask, gf_, I, dx),
-          deriv3<0, 1, 1>(vavail, mask, gf_, I, dx),
-          deriv3<0, 1, 2>(vavail, mask, gf_, I, dx),
-          deriv3<0, 2, 2>(vavail, mask, gf_, I, dx),
-          deriv3<1, 1, 1>(vavail, mask, gf_, I, dx),
-          deriv3<1, 1, 2>(vavail, mask, gf_, I, dx),
-          deriv3<1, 2, 2>(vavail, mask, gf_, I, dx),
-          deriv3<2, 2, 2>(vavail, mask, gf_, I, dx)};
+  return {deriv3<deriv_order, 0, 0, 0>(vavail, mask, gf_, I, dx),
+          deriv3<deriv_order, 0, 0, 1>(vavail, mask, gf_, I, dx),
+          deriv3<deriv_order, 0, 0, 2>(vavail, mask, gf_, I, dx),
+          deriv3<deriv_order, 0, 1, 1>(vavail, mask, gf_, I, dx),
+          deriv3<deriv_order, 0, 1, 2>(vavail, mask, gf_, I, dx),
+          deriv3<deriv_order, 0, 2, 2>(vavail, mask, gf_, I, dx),
+          deriv3<deriv_order, 1, 1, 1>(vavail, mask, gf_, I, dx),
+          deriv3<deriv_order, 1, 1, 2>(vavail, mask, gf_, I, dx),
+          deriv3<deriv_order, 1, 2, 2>(vavail, mask, gf_, I, dx),
+          deriv3<deriv_order, 2, 2, 2>(vavail, mask, gf_, I, dx)};
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-template <typename T>
-CCTK_ATTRIBUTE_NOINLINE void
-calc_copy(const cGH *restrict const cctkGH, const GF3D2<const T> &gf1,
-          const GF3D5<T> &gf0, const GF3D5layout &layout0) {
-  DECLARE_CCTK_ARGUMENTS;
-
-  typedef simd<CCTK_REAL> vreal;
-  typedef simdl<CCTK_REAL> vbool;
-  constexpr size_t vsize = tuple_size_v<vreal>;
-
-  const vec<CCTK_REAL, dim> dx([&](int a) { return CCTK_DELTA_SPACE(a); });
-
-  const Loop::GridDescBaseDevice grid(cctkGH);
-  grid.loop_int_device<0, 0, 0, vsize>(
-      grid.nghostzones,
-      [=] ARITH_DEVICE ARITH_HOST(const PointDesc &p) ARITH_INLINE {
-        const vbool mask = mask_for_loop_tail<vbool>(p.i, p.imax);
-        const GF3D5index index0(layout0, p.I);
-        const auto val = gf1(mask, p.I);
-        gf0.store(mask, index0, val);
-      });
-}
-
-template <typename T>
-CCTK_ATTRIBUTE_NOINLINE void
-calc_derivs(const cGH *restrict const cctkGH, const GF3D2<const T> &gf1,
-            const GF3D5<T> &gf0, const vec<GF3D5<T>, dim> &dgf0,
-            const GF3D5layout &layout0) {
-  DECLARE_CCTK_ARGUMENTS;
-
-  typedef simd<CCTK_REAL> vreal;
-  typedef simdl<CCTK_REAL> vbool;
-  constexpr size_t vsize = tuple_size_v<vreal>;
-
-  const vec<CCTK_REAL, dim> dx([&](int a) { return CCTK_DELTA_SPACE(a); });
-
-  const Loop::GridDescBaseDevice grid(cctkGH);
-  grid.loop_int_device<0, 0, 0, vsize>(
-      grid.nghostzones,
-      [=] ARITH_DEVICE ARITH_HOST(const PointDesc &p) ARITH_INLINE {
-        const vbool mask = mask_for_loop_tail<vbool>(p.i, p.imax);
-        const GF3D5index index0(layout0, p.I);
-        const auto val = gf1(mask, p.I);
-        gf0.store(mask, index0, val);
-        const auto dval = deriv(mask, gf1, p.I, dx);
-        dgf0.store(mask, index0, dval);
-      });
-}
-
-template <typename T>
-CCTK_ATTRIBUTE_NOINLINE void
-calc_derivs2(const cGH *restrict const cctkGH, const GF3D2<const T> &gf1,
-             const GF3D5<T> &gf0, const vec<GF3D5<T>, dim> &dgf0,
-             const smat<GF3D5<T>, dim> &ddgf0, const GF3D5layout &layout0) {
-  DECLARE_CCTK_ARGUMENTS;
-
-  typedef simd<CCTK_REAL> vreal;
-  typedef simdl<CCTK_REAL> vbool;
-  constexpr size_t vsize = tuple_size_v<vreal>;
-
-  const vec<CCTK_REAL, dim> dx([&](int a) { return CCTK_DELTA_SPACE(a); });
-
-  const Loop::GridDescBaseDevice grid(cctkGH);
-  grid.loop_int_device<0, 0, 0, vsize>(
-      grid.nghostzones,
-      [=] ARITH_DEVICE ARITH_HOST(const PointDesc &p) ARITH_INLINE {
-        const vbool mask = mask_for_loop_tail<vbool>(p.i, p.imax);
-        const GF3D5index index0(layout0, p.I);
-        const auto val = gf1(mask, p.I);
-        gf0.store(mask, index0, val);
-        const auto dval = deriv(mask, gf1, p.I, dx);
-        dgf0.store(mask, index0, dval);
-        const auto ddval = deriv2(p.imax - p.i, mask, gf1, p.I, dx);
-        ddgf0.store(mask, index0, ddval);
-      });
-}
-
-template <typename T>
-void CCTK_ATTRIBUTE_NOINLINE calc_copy(const cGH *restrict const cctkGH,
-                                       const vec<GF3D2<const T>, dim> &gf0_,
-                                       const vec<GF3D5<T>, dim> &gf_,
-                                       const GF3D5layout &layout) {
-  for (int a = 0; a < 3; ++a)
-    calc_copy(cctkGH, gf0_(a), gf_(a), layout);
+// Pointwise helpers to load a variable and store it together with its
+// derivatives. These are called from a single fused loop over all
+// variables, so that each stencil is read only once per sweep.
+
+template <int deriv_order, typename T>
+inline ARITH_INLINE ARITH_DEVICE ARITH_HOST void
+store_derivs(const simdl<T> &mask, const vect<int, dim> &I,
+             const GF3D5index &index0, const vec<T, dim> &dx,
+             const GF3D2<const T> &gf1, const GF3D5<T> &gf0,
+             const vec<GF3D5<T>, dim> &dgf0) {
+  gf0.store(mask, index0, gf1(mask, I));
+  dgf0.store(mask, index0, deriv<deriv_order>(mask, gf1, I, dx));
 }
 
-template <typename T>
-void CCTK_ATTRIBUTE_NOINLINE calc_derivs(
-    const cGH *restrict const cctkGH, const vec<GF3D2<const T>, dim> &gf0_,
-    const vec<GF3D5<T>, dim> &gf_, const vec<vec<GF3D5<T>, dim>, dim> &dgf_,
-    const GF3D5layout &layout) {
-  for (int a = 0; a < 3; ++a)
-    calc_derivs(cctkGH, gf0_(a), gf_(a), dgf_(a), layout);
+template <int deriv_order, typename T>
+inline ARITH_INLINE ARITH_DEVICE ARITH_HOST void
+store_derivs2(const int vavail, const simdl<T> &mask, const vect<int, dim> &I,
+              const GF3D5index &index0, const vec<T, dim> &dx,
+              const GF3D2<const T> &gf1, const GF3D5<T> &gf0,
+              const vec<GF3D5<T>, dim> &dgf0,
+              const smat<GF3D5<T>, dim> &ddgf0) {
+  gf0.store(mask, index0, gf1(mask, I));
+  dgf0.store(mask, index0, deriv<deriv_order>(mask, gf1, I, dx));
+  ddgf0.store(mask, index0, deriv2<deriv_order>(vavail, mask, gf1, I, dx));
 }
 
-template <typename T>
-void CCTK_ATTRIBUTE_NOINLINE calc_derivs2(
-    const cGH *restrict const cctkGH, const vec<GF3D2<const T>, dim> &gf0_,
-    const vec<GF3D5<T>, dim> &gf_, const vec<vec<GF3D5<T>, dim>, dim> &dgf_,
-    const vec<smat<GF3D5<T>, dim>, dim> &ddgf_, const GF3D5layout &layout) {
+template <int deriv_order, typename T>
+inline ARITH_INLINE ARITH_DEVICE ARITH_HOST void
+store_derivs(const simdl<T> &mask, const vect<int, dim> &I,
+             const GF3D5index &index0, const vec<T, dim> &dx,
+             const vec<GF3D2<const T>, dim> &gf1,
+             const vec<GF3D5<T>, dim> &gf0,
+             const vec<vec<GF3D5<T>, dim>, dim> &dgf0) {
   for (int a = 0; a < 3; ++a)
-    calc_derivs2(cctkGH, gf0_(a), gf_(a), dgf_(a), ddgf_(a), layout);
+    store_derivs<deriv_order>(mask, I, index0, dx, gf1(a), gf0(a), dgf0(a));
 }
 
-template <typename T>
-void CCTK_ATTRIBUTE_NOINLINE calc_copy(const cGH *restrict const cctkGH,
-                                       const smat<GF3D2<const T>, dim> &gf0_,
-                                       const smat<GF3D5<T>, dim> &gf_,
-                                       const GF3D5layout &layout) {
+template <int deriv_order, typename T>
+inline ARITH_INLINE ARITH_DEVICE ARITH_HOST void
+store_derivs2(const int vavail, const simdl<T> &mask, const vect<int, dim> &I,
+              const GF3D5index &index0, const vec<T, dim> &dx,
+              const vec<GF3D2<const T>, dim> &gf1,
+              const vec<GF3D5<T>, dim> &gf0,
+              const vec<vec<GF3D5<T>, dim>, dim> &dgf0,
+              const vec<smat<GF3D5<T>, dim>, dim> &ddgf0) {
   for (int a = 0; a < 3; ++a)
-    for (int b = a; b < 3; ++b)
-      calc_copy(cctkGH, gf0_(a, b), gf_(a, b), layout);
+    store_derivs2<deriv_order>(vavail, mask, I, index0, dx, gf1(a), gf0(a),
+                               dgf0(a), ddgf0(a));
 }
 
-template <typename T>
-void CCTK_ATTRIBUTE_NOINLINE calc_derivs(
-    const cGH *restrict const cctkGH, const smat<GF3D2<const T>, dim> &gf0_,
-    const smat<GF3D5<T>, dim> &gf_, const smat<vec<GF3D5<T>, dim>, dim> &dgf_,
-    const GF3D5layout &layout) {
+template <int deriv_order, typename T>
+inline ARITH_INLINE ARITH_DEVICE ARITH_HOST void
+store_derivs(const simdl<T> &mask, const vect<int, dim> &I,
+             const GF3D5index &index0, const vec<T, dim> &dx,
+             const smat<GF3D2<const T>, dim> &gf1,
+             const smat<GF3D5<T>, dim> &gf0,
+             const smat<vec<GF3D5<T>, dim>, dim> &dgf0) {
   for (int a = 0; a < 3; ++a)
     for (int b = a; b < 3; ++b)
-      calc_derivs(cctkGH, gf0_(a, b), gf_(a, b), dgf_(a, b), layout);
+      store_derivs<deriv_order>(mask, I, index0, dx, gf1(a, b), gf0(a, b),
+                                dgf0(a, b));
 }
 
-template <typename T>
-void CCTK_ATTRIBUTE_NOINLINE calc_derivs2(
-    const cGH *restrict const cctkGH, const smat<GF3D2<const T>, dim> &gf0_,
-    const smat<GF3D5<T>, dim> &gf_, const smat<vec<GF3D5<T>, dim>, dim> &dgf_,
-    const smat<smat<GF3D5<T>, dim>, dim> &ddgf_, const GF3D5layout &layout) {
+template <int deriv_order, typename T>
+inline ARITH_INLINE ARITH_DEVICE ARITH_HOST void
+store_derivs2(const int vavail, const simdl<T> &mask, const vect<int, dim> &I,
+              const GF3D5index &index0, const vec<T, dim> &dx,
+              const smat<GF3D2<const T>, dim> &gf1,
+              const smat<GF3D5<T>, dim> &gf0,
+              const smat<vec<GF3D5<T>, dim>, dim> &dgf0,
+              const smat<smat<GF3D5<T>, dim>, dim> &ddgf0) {
   for (int a = 0; a < 3; ++a)
     for (int b = a; b < 3; ++b)
-      calc_derivs2(cctkGH, gf0_(a, b), gf_(a, b), dgf_(a, b), ddgf_(a, b),
-                   layout);
+      store_derivs2<deriv_order>(vavail, mask, I, index0, dx, gf1(a, b),
+                                 gf0(a, b), dgf0(a, b), ddgf0(a, b));
 }
 
 } // namespace Weyl
 
-#endif // #ifndef DERIVS_HXX
+#endif // #ifndef WEYL_DERIVS_HXX
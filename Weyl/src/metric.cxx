@@ -11,18 +11,19 @@ void gfs_t::calc_metric() const {
 
   grid.loop_int_device<0, 0, 0, vsize>(
       grid.nghostzones,
-      [layout0 = layout0, //
+      [layout1 = layout1, layout0 = layout0, //
        gf_gamma0 = gf_gamma0, gf_alpha0 = gf_alpha0, gf_beta0 = gf_beta0,
        gf_K0 = gf_K0, gf_dtalpha0 = gf_dtalpha0, gf_dtbeta0 = gf_dtbeta0,
        gf_dgamma0 = gf_dgamma0, gf_dalpha0 = gf_dalpha0, gf_dbeta0 = gf_dbeta0,
-       gf_dtK0 = gf_dtK0, gf_dt2alpha0 = gf_dt2alpha0,
-       gf_dt2beta0 = gf_dt2beta0, gf_dK0 = gf_dK0, gf_ddtalpha0 = gf_ddtalpha0,
+       gf_dtK1 = gf_dtK1, gf_dt2alpha1 = gf_dt2alpha1,
+       gf_dt2beta1 = gf_dt2beta1, gf_dK0 = gf_dK0, gf_ddtalpha0 = gf_ddtalpha0,
        gf_ddtbeta0 = gf_ddtbeta0, gf_ddgamma0 = gf_ddgamma0,
        gf_ddalpha0 = gf_ddalpha0, gf_ddbeta0 = gf_ddbeta0, //
        tile_g4 = tile_g4, tile_dg4 = tile_dg4,
        tile_ddg4 = tile_ddg4 //
   ] ARITH_DEVICE(const PointDesc &p) ARITH_INLINE {
         const vbool mask = mask_for_loop_tail<vbool>(p.i, p.imax);
+        const GF3D2index index1(layout1, p.I);
         const GF3D5index index0(layout0, p.I);
 
         // Load and calculate
@@ -36,8 +37,8 @@ void gfs_t::calc_metric() const {
             gf_dtbeta0(mask, index0), //
             gf_dgamma0(mask, index0), gf_dalpha0(mask, index0),
             gf_dbeta0(mask, index0), //
-            gf_dtK0(mask, index0), gf_dt2alpha0(mask, index0),
-            gf_dt2beta0(mask, index0), //
+            gf_dtK1(mask, index1), gf_dt2alpha1(mask, index1),
+            gf_dt2beta1(mask, index1), //
             gf_dK0(mask, index0), gf_ddtalpha0(mask, index0),
             gf_ddtbeta0(mask, index0), //
             gf_ddgamma0(mask, index0), gf_ddalpha0(mask, index0),
@@ -0,0 +1,84 @@
+#include "weyl.hxx"
+
+#include <defs.hxx>
+#include <loop_device.hxx>
+
+#include <cctk.h>
+#include <cctk_Arguments.h>
+#include <cctk_Parameters.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace Weyl {
+using namespace Loop;
+using namespace std;
+
+extern "C" void Weyl_ParamCheck(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTS_Weyl_ParamCheck;
+  DECLARE_CCTK_PARAMETERS;
+
+  // The Z4c entry point lives in its own thorn, so that Weyl does not
+  // depend on Z4c
+  if (CCTK_EQUALS(weyl_source, "Z4c") && !CCTK_IsThornActive("WeylZ4c"))
+    CCTK_PARAMWARN("weyl_source = \"Z4c\" requires thorn WeylZ4c");
+}
+
+bool patch_is_selected(const cGH *const cctkGH) {
+  DECLARE_CCTK_PARAMETERS;
+
+  // CarpetX uses a refinement factor of 2 between levels
+  int level = 0;
+  while ((1 << level) < cctkGH->cctk_levfac[0])
+    ++level;
+  if (level < min_level)
+    return false;
+  if (max_level >= 0 && level > max_level)
+    return false;
+
+  if (num_shells == 0)
+    return true;
+
+  // Distance of the patch interior from the origin
+  CCTK_REAL r2min = 0, r2max = 0;
+  for (int d = 0; d < dim; ++d) {
+    const int nghosts = cctkGH->cctk_nghostzones[d];
+    const CCTK_REAL x0 = cctkGH->cctk_origin_space[d];
+    const CCTK_REAL dx = cctkGH->cctk_delta_space[d];
+    const CCTK_REAL xmin = x0 + (cctkGH->cctk_lbnd[d] + nghosts) * dx;
+    const CCTK_REAL xmax =
+        x0 + (cctkGH->cctk_lbnd[d] + cctkGH->cctk_lsh[d] - 1 - nghosts) * dx;
+    const CCTK_REAL dmin = xmin > 0 ? xmin : xmax < 0 ? -xmax : 0;
+    const CCTK_REAL dmax = max(fabs(xmin), fabs(xmax));
+    r2min += pow2(dmin);
+    r2max += pow2(dmax);
+  }
+  const CCTK_REAL rmin = sqrt(r2min);
+  const CCTK_REAL rmax = sqrt(r2max);
+
+  for (int n = 0; n < num_shells; ++n)
+    if (rmin <= shell_rmax[n] && rmax >= shell_rmin[n])
+      return true;
+  return false;
+}
+
+void mask_scalars(const cGH *const cctkGH) {
+  const array<int, dim> indextype = {0, 0, 0};
+  const GF3D2layout layout1(cctkGH, indextype);
+  const GridDescBaseDevice grid(cctkGH);
+
+  const int group = CCTK_GroupIndex("Weyl::weyl_scalars");
+  assert(group >= 0);
+  const int var0 = CCTK_FirstVarIndexI(group);
+  const int nvars = CCTK_NumVarsInGroupI(group);
+  for (int vi = var0; vi < var0 + nvars; ++vi) {
+    const GF3D2<CCTK_REAL> gf1(
+        layout1, static_cast<CCTK_REAL *>(CCTK_VarDataPtrI(cctkGH, 0, vi)));
+    grid.loop_int_device<0, 0, 0>(
+        grid.nghostzones,
+        [=] ARITH_DEVICE(const PointDesc &p) ARITH_INLINE { gf1(p.I) = 0; });
+  }
+}
+
+} // namespace Weyl
@@ -1,248 +1,47 @@
 #include "derivs.hxx"
 #include "physics.hxx"
-#include "tensor.hxx"
+#include "weyl_vars.hxx"
+
+#include <cplx.hxx>
+#include <defs.hxx>
+#include <mat.hxx>
+#include <simd.hxx>
+#include <vec.hxx>
 
 #include <cctk.h>
+#include <cctk_Arguments.h>
+#include <cctk_Parameters.h>
 
-#include <algorithm>
 #include <array>
 #include <cassert>
+#include <chrono>
 #include <cmath>
-#include <random>
+#include <functional>
+#include <iostream>
 
 namespace Weyl {
 using namespace std;
 
-// TODO: Use GoogleTest instead of assert
+namespace {
 
-extern "C" void Weyl_Test(CCTK_ARGUMENTS) {
-  DECLARE_CCTK_ARGUMENTS;
+typedef simd<CCTK_REAL> vreal;
+typedef simdl<CCTK_REAL> vbool;
+constexpr int vsize = tuple_size_v<vreal>;
 
-  // Test tensors
-  {
-    mt19937 engine(42);
-    uniform_int_distribution<int> dist(-10, 10);
-    const auto rand10{[&]() { return double(dist(engine)); }};
-    const auto randmat10{[&]() {
-      array<array<double, 3>, 3> arr;
-      for (int a = 0; a < 3; ++a)
-        for (int b = 0; b < 3; ++b)
-          arr[a][b] = rand10();
-      return mat3<double, DN, DN>(
-          [&](int a, int b) { return arr[min(a, b)][max(a, b)]; });
-    }};
-
-    const mat3<double, DN, DN> Z([&](int a, int b) { return double(0); });
-    const mat3<double, DN, DN> I([&](int a, int b) { return double(a == b); });
-    assert(I != Z);
-    const mat3<double, UP, UP> Zup([&](int a, int b) { return double(0); });
-    const mat3<double, UP, UP> Iup(
-        [&](int a, int b) { return double(a == b); });
-    assert(Iup != Zup);
-
-    for (int n = 0; n < 100; ++n) {
-      const mat3<double, DN, DN> A = randmat10();
-      const mat3<double, DN, DN> B = randmat10();
-      const mat3<double, DN, DN> C = randmat10();
-      const double a = rand10();
-      const double b = rand10();
-
-      assert((A + B) + C == A + (B + C));
-      assert(Z + A == A);
-      assert(A + Z == A);
-      assert(A + (-A) == Z);
-      assert((-A) + A == Z);
-      assert(A - B == A + (-B));
-      assert(A + B == B + A);
-
-      assert(1 * A == A);
-      assert(0 * A == Z);
-      assert(-1 * A == -A);
-      // assert(mul(a * A, B) == a * mul(A, B));
-      assert((a * b) * A == a * (b * A));
-      assert(a * (A + B) == a * A + a * B);
-      assert((a + b) * A == a * A + b * A);
-
-      // assert(mul(mul(A, B), C) == mul(A, mul(B, C)));
-      // DNUP  assert(mul(I, A) == A);
-      // DNUP  assert(mul(A, I) == A);
-      // DNUP  assert(mul(Z, A) == Z);
-      // DNUP  assert(mul(A, Z) == Z);
-
-      assert(Z.det() == 0);
-      assert(I.det() == 1);
-      assert((a * A).det() == pow3(a) * A.det());
-
-      assert(Z.inv(1) == Zup);
-      assert(I.inv(1) == Iup);
-
-      // DNUP assert(mul(A.inv(1), A) == A.det() * Iup);
-      // DNUP assert(mul(A, A.inv(1)) == A.det() * Iup);
-
-      assert((a * A).inv(1) == pow2(a) * A.inv(1));
-    }
-  }
+////////////////////////////////////////////////////////////////////////////////
 
-  // Test 4-tensors
-  {
-    mt19937 engine(42);
-    uniform_int_distribution<int> dist(-10, 10);
-    const auto rand10{[&]() { return double(dist(engine)); }};
-    const auto randmat10{[&]() {
-      array<array<double, 4>, 4> arr;
-      for (int a = 0; a < 4; ++a)
-        for (int b = 0; b < 4; ++b)
-          arr[a][b] = rand10();
-      return mat4<double, DN, DN>(
-          [&](int a, int b) { return arr[min(a, b)][max(a, b)]; });
-    }};
-
-    const mat4<double, DN, DN> Z([&](int a, int b) { return double(0); });
-    const mat4<double, DN, DN> I([&](int a, int b) { return double(a == b); });
-    assert(I != Z);
-    const mat4<double, UP, UP> Zup([&](int a, int b) { return double(0); });
-    const mat4<double, UP, UP> Iup(
-        [&](int a, int b) { return double(a == b); });
-    assert(Iup != Zup);
-
-    for (int n = 0; n < 100; ++n) {
-      const mat4<double, DN, DN> A = randmat10();
-      const mat4<double, DN, DN> B = randmat10();
-      const mat4<double, DN, DN> C = randmat10();
-      const double a = rand10();
-      const double b = rand10();
-
-      assert((A + B) + C == A + (B + C));
-      assert(Z + A == A);
-      assert(A + Z == A);
-      assert(A + (-A) == Z);
-      assert((-A) + A == Z);
-      assert(A - B == A + (-B));
-      assert(A + B == B + A);
-
-      assert(1 * A == A);
-      assert(0 * A == Z);
-      assert(-1 * A == -A);
-      // assert(mul(a * A, B) == a * mul(A, B));
-      assert((a * b) * A == a * (b * A));
-      assert(a * (A + B) == a * A + a * B);
-      assert((a + b) * A == a * A + b * A);
-
-      // assert(mul(mul(A, B), C) == mul(A, mul(B, C)));
-      // DNUP  assert(mul(I, A) == A);
-      // DNUP  assert(mul(A, I) == A);
-      // DNUP  assert(mul(Z, A) == Z);
-      // DNUP  assert(mul(A, Z) == Z);
-
-      assert(Z.det() == 0);
-      assert(I.det() == 1);
-      assert((a * A).det() == pow4(a) * A.det());
-
-      assert(Z.inv(1) == Zup);
-      assert(I.inv(1) == Iup);
-
-      // DNUP assert(mul(A.inv(1), A) == A.det() * Iup);
-      // DNUP assert(mul(A, A.inv(1)) == A.det() * Iup);
-
-      assert((a * A).inv(1) == pow3(a) * A.inv(1));
-    }
-  }
-
-  // Test antisymmetric 4-tensors
-  {
-    mt19937 engine(42);
-    uniform_int_distribution<int> dist(-10, 10);
-    const auto rand10{[&]() { return double(dist(engine)); }};
-    const auto randamat10{[&]() {
-      array<array<double, 4>, 4> arr;
-      for (int a = 0; a < 4; ++a)
-        for (int b = 0; b < 4; ++b)
-          arr[a][b] = rand10();
-      return amat4<double, DN, DN>(
-          [&](int a, int b) { return arr[min(a, b)][max(a, b)]; });
-    }};
-
-    const amat4<double, DN, DN> Z([&](int a, int b) { return double(0); });
-
-    for (int n = 0; n < 100; ++n) {
-      const amat4<double, DN, DN> A = randamat10();
-      const amat4<double, DN, DN> B = randamat10();
-      const amat4<double, DN, DN> C = randamat10();
-      const double a = rand10();
-      const double b = rand10();
-
-      assert((A + B) + C == A + (B + C));
-      assert(Z + A == A);
-      assert(A + Z == A);
-      assert(A + (-A) == Z);
-      assert((-A) + A == Z);
-      assert(A - B == A + (-B));
-      assert(A + B == B + A);
-
-      assert(1 * A == A);
-      assert(0 * A == Z);
-      assert(-1 * A == -A);
-      assert((a * b) * A == a * (b * A));
-      assert(a * (A + B) == a * A + a * B);
-      assert((a + b) * A == a * A + b * A);
-    }
-  }
-
-  // Test Riemann tensors
-  {
-    mt19937 engine(42);
-    uniform_int_distribution<int> dist(-10, 10);
-    const auto rand10{[&]() { return double(dist(engine)); }};
-    const auto randrten10{[&]() {
-      array<array<array<array<double, 4>, 4>, 4>, 4> arr;
-      for (int a = 0; a < 4; ++a)
-        for (int b = 0; b < 4; ++b)
-          for (int c = 0; c < 4; ++c)
-            for (int d = 0; d < 4; ++d)
-              arr[a][b][c][d] = rand10();
-      return rten4<double, DN, DN, DN, DN>(
-          [&](int a, int b, int c, int d) { return arr[a][b][c][d]; });
-    }};
-
-    const rten4<double, DN, DN, DN, DN> Z(
-        [&](int a, int b, int c, int d) { return double(0); });
-
-    for (int n = 0; n < 100; ++n) {
-      const rten4<double, DN, DN, DN, DN> A = randrten10();
-      const rten4<double, DN, DN, DN, DN> B = randrten10();
-      const rten4<double, DN, DN, DN, DN> C = randrten10();
-      const double a = rand10();
-      const double b = rand10();
-
-      assert((A + B) + C == A + (B + C));
-      assert(Z + A == A);
-      assert(A + Z == A);
-      assert(A + (-A) == Z);
-      assert((-A) + A == Z);
-      assert(A - B == A + (-B));
-      assert(A + B == B + A);
-
-      assert(1 * A == A);
-      assert(0 * A == Z);
-      assert(-1 * A == -A);
-      assert((a * b) * A == a * (b * A));
-      assert(a * (A + B) == a * A + a * B);
-      assert((a + b) * A == a * A + b * A);
-    }
-  }
-
-  // Test derivatives
+// Test finite differencing stencils. A stencil of order `deriv_order`
+// needs to be exact for polynomials up to that order.
 
+template <int deriv_order> void test_derivs() {
   static_assert(deriv_order % 2 == 0, "");
   constexpr int required_ghosts = deriv_order / 2 + 1;
   constexpr int fences = 3;
-  constexpr int vsize = tuple_size_v<simd<double> >;
-  const double eps = 1.0e-12;
+  const double eps = 1.0e-10;
 
   // deriv
   for (int npoints = 1; npoints <= vsize; ++npoints) {
     for (int order = 0; order <= deriv_order; ++order) {
-      // CCTK_VINFO("Testing deriv order=%d", order);
       array<double, 2 * (fences + required_ghosts) + vsize> arr;
       for (size_t i = 0; i < arr.size(); ++i)
         arr[i] = NAN;
@@ -252,9 +51,10 @@ extern "C" void Weyl_Test(CCTK_ARGUMENTS) {
       const simd<double> expected =
           order == 0 ? 0 : order * pown(iota<simd<double> >(), order - 1);
       const simdl<double> mask = mask_for_loop_tail<simdl<double> >(0, npoints);
-      const simd<double> found = deriv1d(mask, var, 1, 1.0);
+      const simd<double> found = deriv1d<deriv_order>(mask, var, 1, 1.0);
       if (!(all(fabs(found - expected) <= eps || !mask)))
         cout << "deriv:\n"
+             << "  deriv_order: " << deriv_order << "\n"
              << "  npoints: " << npoints << "\n"
              << "  order: " << order << "\n"
              << "  expected: " << expected << "\n"
@@ -263,40 +63,9 @@ extern "C" void Weyl_Test(CCTK_ARGUMENTS) {
     }
   }
 
-  // deriv (upwind)
-  for (int npoints = 1; npoints <= vsize; ++npoints) {
-    for (int order = 0; order <= deriv_order; ++order) {
-      for (int sign = 0; sign <= 1; ++sign) {
-        // CCTK_VINFO("Testing deriv (upwind) order=%d sign=%d", order, sign);
-        array<double, 2 * (fences + required_ghosts) + vsize> arr;
-        for (size_t i = 0; i < arr.size(); ++i)
-          arr[i] = NAN;
-        double *const var = &arr[fences + required_ghosts];
-        for (int i = -deriv_order / 2 - 1; i < vsize + deriv_order / 2 + 1; ++i)
-          var[i] = pown(i, order);
-        const simd<double> vel = sign ? -1 : +1;
-        const simd<double> expected =
-            vel *
-            (order == 0 ? 0 : order * pown(iota<simd<double> >(), order - 1));
-        const simdl<double> mask =
-            mask_for_loop_tail<simdl<double> >(0, npoints);
-        const simd<double> found = deriv1d_upwind(mask, var, 1, vel, 1.0);
-        if (!(all(fabs(found - expected) <= eps || !mask)))
-          cout << "deriv_upwind:\n"
-               << "  npoints: " << npoints << "\n"
-               << "  order: " << order << "\n"
-               << "  sign: " << sign << "\n"
-               << "  expected: " << expected << "\n"
-               << "  found: " << found << "\n";
-        assert(all(fabs(found - expected) <= eps || !mask));
-      }
-    }
-  }
-
   // deriv2
   for (int npoints = 1; npoints <= vsize; ++npoints) {
     for (int order = 0; order <= deriv_order; ++order) {
-      // CCTK_VINFO("Testing deriv2 order=%d", order);
       array<double, 2 * (fences + required_ghosts) + vsize> arr;
       for (size_t i = 0; i < arr.size(); ++i)
         arr[i] = NAN;
@@ -308,9 +77,36 @@ extern "C" void Weyl_Test(CCTK_ARGUMENTS) {
               ? 0
               : order * (order - 1) * pown(iota<simd<double> >(), order - 2);
       const simdl<double> mask = mask_for_loop_tail<simdl<double> >(0, npoints);
-      const simd<double> found = deriv2_1d(mask, var, 1, 1.0);
+      const simd<double> found = deriv2_1d<deriv_order>(mask, var, 1, 1.0);
+      if (!(all(fabs(found - expected) <= eps || !mask)))
+        cout << "deriv2:\n"
+             << "  deriv_order: " << deriv_order << "\n"
+             << "  npoints: " << npoints << "\n"
+             << "  order: " << order << "\n"
+             << "  expected: " << expected << "\n"
+             << "  found: " << found << "\n";
+      assert(all(fabs(found - expected) <= eps || !mask));
+    }
+  }
+
+  // deriv3
+  for (int npoints = 1; npoints <= vsize; ++npoints) {
+    for (int order = 0; order <= deriv_order; ++order) {
+      array<double, 2 * (fences + required_ghosts) + vsize> arr;
+      for (size_t i = 0; i < arr.size(); ++i)
+        arr[i] = NAN;
+      double *const var = &arr[fences + required_ghosts];
+      for (int i = -required_ghosts; i < vsize + required_ghosts; ++i)
+        var[i] = pown(i, order);
+      const simd<double> expected =
+          order < 3 ? 0
+                    : order * (order - 1) * (order - 2) *
+                          pown(iota<simd<double> >(), order - 3);
+      const simdl<double> mask = mask_for_loop_tail<simdl<double> >(0, npoints);
+      const simd<double> found = deriv3_1d<deriv_order>(mask, var, 1, 1.0);
       if (!(all(fabs(found - expected) <= eps || !mask)))
-        cout << "deriv_upwind:\n"
+        cout << "deriv3:\n"
+             << "  deriv_order: " << deriv_order << "\n"
              << "  npoints: " << npoints << "\n"
              << "  order: " << order << "\n"
              << "  expected: " << expected << "\n"
@@ -323,7 +119,6 @@ extern "C" void Weyl_Test(CCTK_ARGUMENTS) {
   for (int npoints = 1; npoints <= vsize; ++npoints) {
     for (int orderj = 0; orderj <= deriv_order; ++orderj) {
       for (int orderi = 0; orderi <= deriv_order; ++orderi) {
-        // CCTK_VINFO("Testing deriv2 (mixed) order=%d,%d", orderi, orderj);
         array<array<double, 2 * (fences + required_ghosts) + vsize>,
               2 * (fences + required_ghosts) + 1>
             arr;
@@ -344,9 +139,10 @@ extern "C" void Weyl_Test(CCTK_ARGUMENTS) {
         const simdl<double> mask =
             mask_for_loop_tail<simdl<double> >(0, npoints);
         const simd<double> found =
-            deriv2_2d(npoints, mask, var, di, dj, 1.0, 1.0);
+            deriv2_2d<deriv_order>(npoints, mask, var, di, dj, 1.0, 1.0);
         if (!(all(fabs(found - expected) <= eps || !mask)))
           cout << "deriv2_mixed:\n"
+               << "  deriv_order: " << deriv_order << "\n"
                << "  npoints: " << npoints << "\n"
                << "  orderi: " << orderi << "\n"
                << "  orderj: " << orderj << "\n"
@@ -358,4 +154,372 @@ extern "C" void Weyl_Test(CCTK_ARGUMENTS) {
   }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+
+// Analytic spacetimes. The ADM variables are given in closed form; all
+// their derivatives are evaluated with high-order finite differences
+// in long double precision, so that they are accurate to roundoff in
+// double precision.
+
+typedef long double real_t;
+typedef array<real_t, 4> point_t; // t, x, y, z
+typedef function<real_t(const point_t &)> scalar_t;
+
+struct adm_t {
+  smat<real_t, 3> gamma;
+  real_t alpha;
+  vec<real_t, 3> beta;
+};
+typedef function<adm_t(const point_t &)> spacetime_t;
+
+real_t fd_deriv(const scalar_t &f, const point_t &p, const int dir) {
+  const real_t h = 1.0e-3L;
+  const auto diff = [&](const int n) {
+    point_t pp = p, pm = p;
+    pp[dir] += n * h;
+    pm[dir] -= n * h;
+    return f(pp) - f(pm);
+  };
+  return (-1 / real_t(280) * diff(4) + 4 / real_t(105) * diff(3) -
+          1 / real_t(5) * diff(2) + 4 / real_t(5) * diff(1)) /
+         h;
+}
+
+scalar_t fd_deriv(const scalar_t &f, const int dir) {
+  return [=](const point_t &p) { return fd_deriv(f, p, dir); };
+}
+
+// The input variables of `weyl_vars_metric`
+struct weyl_inputs_t {
+  smat<vreal, 3> gamma;
+  vreal alpha;
+  vec<vreal, 3> beta;
+  smat<vreal, 3> K;
+  vreal dtalpha;
+  vec<vreal, 3> dtbeta;
+  smat<vec<vreal, 3>, 3> dgamma;
+  vec<vreal, 3> dalpha;
+  vec<vec<vreal, 3>, 3> dbeta;
+  smat<vreal, 3> dtK;
+  vreal dt2alpha;
+  vec<vreal, 3> dt2beta;
+  smat<vec<vreal, 3>, 3> dK;
+  vec<vreal, 3> ddtalpha;
+  vec<vec<vreal, 3>, 3> ddtbeta;
+  smat<smat<vreal, 3>, 3> ddgamma;
+  smat<vreal, 3> ddalpha;
+  vec<smat<vreal, 3>, 3> ddbeta;
+};
+
+weyl_inputs_t calc_inputs(const spacetime_t &spacetime, const point_t &p0) {
+  const auto gamma = [=](int a, int b) -> scalar_t {
+    return [=](const point_t &p) { return spacetime(p).gamma(a, b); };
+  };
+  const scalar_t alpha = [=](const point_t &p) { return spacetime(p).alpha; };
+  const auto beta = [=](int a) -> scalar_t {
+    return [=](const point_t &p) { return spacetime(p).beta(a); };
+  };
+  const auto betal = [=](int a) -> scalar_t {
+    return [=](const point_t &p) {
+      const adm_t adm = spacetime(p);
+      return sum<3>([&](int x) { return adm.gamma(a, x) * adm.beta(x); });
+    };
+  };
+  // K_ij = (D_i beta_j + D_j beta_i - dt gamma_ij) / (2 alpha)
+  const auto K = [=](int a, int b) -> scalar_t {
+    return [=](const point_t &p) {
+      const adm_t adm = spacetime(p);
+      const smat<real_t, 3> gu = calc_inv(adm.gamma, calc_det(adm.gamma));
+      const auto dgamma = [&](int x, int y, int z) {
+        return fd_deriv(gamma(x, y), p, 1 + z);
+      };
+      const auto Gammal = [&](int x, int y, int z) {
+        return (dgamma(x, y, z) + dgamma(x, z, y) - dgamma(y, z, x)) / 2;
+      };
+      const auto Dbetal = [&](int x, int y) {
+        return fd_deriv(betal(y), p, 1 + x) - sum<3>([&](int z) {
+                 return Gammal(z, x, y) * sum<3>([&](int w) {
+                          return gu(z, w) * betal(w)(p);
+                        });
+               });
+      };
+      return (Dbetal(a, b) + Dbetal(b, a) - fd_deriv(gamma(a, b), p, 0)) /
+             (2 * adm.alpha);
+    };
+  };
+
+  const auto eval = [&](const scalar_t &f) { return vreal(CCTK_REAL(f(p0))); };
+  const auto eval_d = [&](const scalar_t &f) {
+    return vec<vreal, 3>([&](int c) { return eval(fd_deriv(f, 1 + c)); });
+  };
+  const auto eval_dd = [&](const scalar_t &f) {
+    return smat<vreal, 3>([&](int c, int d) {
+      return eval(fd_deriv(fd_deriv(f, 1 + c), 1 + d));
+    });
+  };
+  const auto eval_dt = [&](const scalar_t &f) { return eval(fd_deriv(f, 0)); };
+  const auto eval_dt2 = [&](const scalar_t &f) {
+    return eval(fd_deriv(fd_deriv(f, 0), 0));
+  };
+  const auto eval_ddt = [&](const scalar_t &f) {
+    return eval_d(fd_deriv(f, 0));
+  };
+
+  weyl_inputs_t inputs;
+  inputs.gamma =
+      smat<vreal, 3>([&](int a, int b) { return eval(gamma(a, b)); });
+  inputs.alpha = eval(alpha);
+  inputs.beta = vec<vreal, 3>([&](int a) { return eval(beta(a)); });
+  inputs.K = smat<vreal, 3>([&](int a, int b) { return eval(K(a, b)); });
+  inputs.dtalpha = eval_dt(alpha);
+  inputs.dtbeta = vec<vreal, 3>([&](int a) { return eval_dt(beta(a)); });
+  inputs.dgamma = smat<vec<vreal, 3>, 3>(
+      [&](int a, int b) { return eval_d(gamma(a, b)); });
+  inputs.dalpha = eval_d(alpha);
+  inputs.dbeta = vec<vec<vreal, 3>, 3>([&](int a) { return eval_d(beta(a)); });
+  inputs.dtK = smat<vreal, 3>([&](int a, int b) { return eval_dt(K(a, b)); });
+  inputs.dt2alpha = eval_dt2(alpha);
+  inputs.dt2beta = vec<vreal, 3>([&](int a) { return eval_dt2(beta(a)); });
+  inputs.dK =
+      smat<vec<vreal, 3>, 3>([&](int a, int b) { return eval_d(K(a, b)); });
+  inputs.ddtalpha = eval_ddt(alpha);
+  inputs.ddtbeta =
+      vec<vec<vreal, 3>, 3>([&](int a) { return eval_ddt(beta(a)); });
+  inputs.ddgamma = smat<smat<vreal, 3>, 3>(
+      [&](int a, int b) { return eval_dd(gamma(a, b)); });
+  inputs.ddalpha = eval_dd(alpha);
+  inputs.ddbeta =
+      vec<smat<vreal, 3>, 3>([&](int a) { return eval_dd(beta(a)); });
+  return inputs;
+}
+
+// Weyl scalars via the 4-metric, i.e. the code path used by `Weyl_Weyl`
+array<cplx<vreal>, 5> calc_scalars_4d(const weyl_inputs_t &in,
+                                      const vec<vreal, 4> &coord) {
+  const weyl_vars_metric<vreal> metric(
+      in.gamma, in.alpha, in.beta, in.K, in.dtalpha, in.dtbeta, in.dgamma,
+      in.dalpha, in.dbeta, in.dtK, in.dt2alpha, in.dt2beta, in.dK,
+      in.ddtalpha, in.ddtbeta, in.ddgamma, in.ddalpha, in.ddbeta);
+  const weyl_vars_curvature<vreal> curvature(metric.g, metric.dg, metric.ddg);
+  const weyl_vars_scalars<vreal> scalars(coord, metric.g, curvature.R,
+                                         curvature.C);
+  return {scalars.Psi0, scalars.Psi1, scalars.Psi2, scalars.Psi3,
+          scalars.Psi4};
+}
+
+// Spatial Christoffel symbols and Ricci tensor
+struct spatial_curvature_t {
+  smat<vreal, 3> gu;
+  vec<smat<vreal, 3>, 3> Gamma;
+  smat<vreal, 3> R;
+};
+
+spatial_curvature_t calc_spatial_curvature(const weyl_inputs_t &in) {
+  spatial_curvature_t sc;
+  sc.gu = calc_inv(in.gamma, calc_det(in.gamma));
+  const auto Gammal = calc_gammal(in.dgamma);
+  sc.Gamma = calc_gamma(sc.gu, Gammal);
+  const auto dgu = calc_dgu(sc.gu, in.dgamma);
+  const auto dGammal = calc_dgammal(in.ddgamma);
+  const auto dGamma = calc_dgamma(sc.gu, dgu, Gammal, dGammal);
+  const auto Rm = calc_riemann(in.gamma, sc.Gamma, dGamma);
+  sc.R = calc_ricci(sc.gu, Rm);
+  return sc;
+}
+
+// Weyl scalars via the electric and magnetic parts, i.e. the code path
+// used by `WeylZ4c_Weyl` in thorn WeylZ4c
+array<cplx<vreal>, 5> calc_scalars_3p1(const weyl_inputs_t &in,
+                                       const vec<vreal, 3> &coord) {
+  const spatial_curvature_t sc = calc_spatial_curvature(in);
+  const weyl_vars_3p1<vreal> vars(coord, in.gamma, sc.gu, sc.Gamma, in.K,
+                                  in.dK, sc.R,
+                                  zero<vec<vreal, 3> >()(),
+                                  zero<smat<vreal, 3> >()());
+  return {vars.Psi0, vars.Psi1, vars.Psi2, vars.Psi3, vars.Psi4};
+}
+
+void check_scalars(const char *const name, const char *const method,
+                   const array<cplx<vreal>, 5> &found,
+                   const array<cplx<CCTK_REAL>, 5> &expected,
+                   const CCTK_REAL eps) {
+  for (int n = 0; n < 5; ++n) {
+    const vreal err_re = fabs(real(found[n]) - real(expected[n]));
+    const vreal err_im = fabs(imag(found[n]) - imag(expected[n]));
+    if (!all(err_re <= eps && err_im <= eps)) {
+      cout << name << " (" << method << "):\n"
+           << "  Psi" << n << "\n"
+           << "  expected: " << real(expected[n]) << " + i "
+           << imag(expected[n]) << "\n"
+           << "  found: " << real(found[n]) << " + i " << imag(found[n])
+           << "\n";
+      CCTK_VERROR("Weyl scalar Psi%d for %s (%s) is wrong", n, name, method);
+    }
+  }
+}
+
+void test_spacetime(const char *const name, const spacetime_t &spacetime,
+                    const point_t &p,
+                    const array<cplx<CCTK_REAL>, 5> &expected,
+                    const CCTK_REAL eps) {
+  const weyl_inputs_t inputs = calc_inputs(spacetime, p);
+  const vec<vreal, 4> coord4([&](int a) { return vreal(CCTK_REAL(p[a])); });
+  const vec<vreal, 3> coord3{coord4(1), coord4(2), coord4(3)};
+  check_scalars(name, "4-metric", calc_scalars_4d(inputs, coord4), expected,
+                eps);
+  check_scalars(name, "3+1", calc_scalars_3p1(inputs, coord3), expected, eps);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+template <typename F> double time_ns_per_point(const int npoints, const F &f) {
+  const auto t0 = chrono::steady_clock::now();
+  for (int i = 0; i < npoints; i += vsize)
+    f(i);
+  const auto t1 = chrono::steady_clock::now();
+  return chrono::duration<double, nano>(t1 - t0).count() / npoints;
+}
+
+void benchmark(const weyl_inputs_t &in, const vec<vreal, 4> &coord4,
+               const int npoints) {
+  // Scale the metric slightly from point to point so that nothing can
+  // be hoisted out of the loops
+  const auto scale = [](const int i) {
+    return vreal(1 + 1.0e-12 * (i % 7)) + 1.0e-13 * iota<vreal>();
+  };
+  const vec<vreal, 3> coord3{coord4(1), coord4(2), coord4(3)};
+  vreal sink = 0;
+
+  const weyl_vars_metric<vreal> metric0(
+      in.gamma, in.alpha, in.beta, in.K, in.dtalpha, in.dtbeta, in.dgamma,
+      in.dalpha, in.dbeta, in.dtK, in.dt2alpha, in.dt2beta, in.dK,
+      in.ddtalpha, in.ddtbeta, in.ddgamma, in.ddalpha, in.ddbeta);
+  const weyl_vars_curvature<vreal> curvature0(metric0.g, metric0.dg,
+                                              metric0.ddg);
+
+  const double t_metric = time_ns_per_point(npoints, [&](const int i) {
+    const weyl_vars_metric<vreal> metric(
+        scale(i) * in.gamma, in.alpha, in.beta, in.K, in.dtalpha, in.dtbeta,
+        in.dgamma, in.dalpha, in.dbeta, in.dtK, in.dt2alpha, in.dt2beta, in.dK,
+        in.ddtalpha, in.ddtbeta, in.ddgamma, in.ddalpha, in.ddbeta);
+    sink += metric.ddg(1, 2)(3, 3);
+  });
+
+  const double t_curvature = time_ns_per_point(npoints, [&](const int i) {
+    const weyl_vars_curvature<vreal> curvature(scale(i) * metric0.g,
+                                               metric0.dg, metric0.ddg);
+    sink += curvature.C(0, 1, 0, 1);
+  });
+
+  const double t_scalars = time_ns_per_point(npoints, [&](const int i) {
+    const weyl_vars_scalars<vreal> scalars(coord4, scale(i) * metric0.g,
+                                           curvature0.R, curvature0.C);
+    sink += real(scalars.Psi4);
+  });
+
+  const double t_fused = time_ns_per_point(npoints, [&](const int i) {
+    const weyl_vars_metric<vreal> metric(
+        scale(i) * in.gamma, in.alpha, in.beta, in.K, in.dtalpha, in.dtbeta,
+        in.dgamma, in.dalpha, in.dbeta, in.dtK, in.dt2alpha, in.dt2beta, in.dK,
+        in.ddtalpha, in.ddtbeta, in.ddgamma, in.ddalpha, in.ddbeta);
+    const weyl_vars_curvature<vreal> curvature(metric.g, metric.dg,
+                                               metric.ddg);
+    const weyl_vars_scalars<vreal> scalars(coord4, metric.g, curvature.R,
+                                           curvature.C);
+    sink += real(scalars.Psi4);
+  });
+
+  const spatial_curvature_t sc = calc_spatial_curvature(in);
+
+  const double t_3p1 = time_ns_per_point(npoints, [&](const int i) {
+    const weyl_vars_3p1<vreal> vars(
+        coord3, scale(i) * in.gamma, sc.gu, sc.Gamma, in.K, in.dK, sc.R,
+        zero<vec<vreal, 3> >()(), zero<smat<vreal, 3> >()());
+    sink += real(vars.Psi4);
+  });
+
+  CCTK_VINFO("Benchmark (%d points, %d-wide SIMD):", npoints, vsize);
+  CCTK_VINFO("  weyl_vars_metric:    %8.1f ns/point", t_metric);
+  CCTK_VINFO("  weyl_vars_curvature: %8.1f ns/point", t_curvature);
+  CCTK_VINFO("  weyl_vars_scalars:   %8.1f ns/point", t_scalars);
+  CCTK_VINFO("  fused (all three):   %8.1f ns/point", t_fused);
+  CCTK_VINFO("  weyl_vars_3p1:       %8.1f ns/point", t_3p1);
+  // Ensure the results are used
+  if (!all(sink == sink))
+    CCTK_WARN(CCTK_WARN_ALERT, "Benchmark produced non-finite results");
+}
+
+} // namespace
+
+extern "C" void Weyl_Test(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTS;
+  DECLARE_CCTK_PARAMETERS;
+
+#ifndef __CUDACC__
+
+  // Test derivatives
+
+  test_derivs<2>();
+  test_derivs<4>();
+  test_derivs<6>();
+  test_derivs<8>();
+
+  // Test Weyl scalars
+
+  // Schwarzschild in Kerr-Schild coordinates. The tetrad is adapted to
+  // the principal null directions; only Psi2 = -M/r^3 is nonzero.
+  const real_t M = 1;
+  const spacetime_t schwarzschild = [=](const point_t &p) {
+    const real_t r = sqrt(pow2(p[1]) + pow2(p[2]) + pow2(p[3]));
+    const real_t H = 2 * M / r;
+    const vec<real_t, 3> l{p[1] / r, p[2] / r, p[3] / r};
+    adm_t adm;
+    adm.gamma = smat<real_t, 3>(
+        [&](int a, int b) { return real_t(a == b) + H * l(a) * l(b); });
+    adm.alpha = 1 / sqrt(1 + H);
+    adm.beta = vec<real_t, 3>([&](int a) { return H / (1 + H) * l(a); });
+    return adm;
+  };
+  const cplx<CCTK_REAL> z(0, 0);
+  {
+    const point_t p{0, 3, 2, 4};
+    const CCTK_REAL r = sqrt(CCTK_REAL(pow2(p[1]) + pow2(p[2]) + pow2(p[3])));
+    const CCTK_REAL Psi2 = -CCTK_REAL(M) / pow3(r);
+    test_spacetime("Schwarzschild", schwarzschild, p,
+                   {z, z, cplx<CCTK_REAL>(Psi2, 0), z, z}, 1.0e-10);
+  }
+
+  // Linearized plane gravitational wave travelling in the x direction,
+  // h_+ = A sin(omega (t - x)), observed on the x axis. With the
+  // past-directed time leg of the tetrad the outgoing wave appears in
+  // Psi0 = d^2 h_+ / dt^2 (up to corrections of order A^2).
+  const real_t A = 1.0e-6L, omega = 0.5L;
+  const spacetime_t wave = [=](const point_t &p) {
+    const real_t h = A * sin(omega * (p[0] - p[1]));
+    adm_t adm;
+    adm.gamma = smat<real_t, 3>([&](int a, int b) {
+      return a != b ? 0 : a == 1 ? 1 + h : a == 2 ? 1 - h : 1;
+    });
+    adm.alpha = 1;
+    adm.beta = vec<real_t, 3>{0, 0, 0};
+    return adm;
+  };
+  {
+    const point_t p{0.3L, 5, 0, 0};
+    const CCTK_REAL Psi0 = -A * pow2(omega) * sin(omega * (p[0] - p[1]));
+    test_spacetime("linearized wave", wave, p,
+                   {cplx<CCTK_REAL>(Psi0, 0), z, z, z, z}, 1.0e-12);
+  }
+
+  // Benchmark
+
+  if (benchmark_npoints > 0) {
+    const point_t p{0, 3, 2, 4};
+    const vec<vreal, 4> coord4([&](int a) { return vreal(CCTK_REAL(p[a])); });
+    benchmark(calc_inputs(schwarzschild, p), coord4, benchmark_npoints);
+  }
+
+#endif
+}
+
 } // namespace Weyl
@@ -83,9 +83,9 @@ gfs_t::gfs_t(const cGH *const cctkGH)
       gf_dtbeta1{GETVAR2(const CCTK_REAL, dtbetax),
                  GETVAR2(const CCTK_REAL, dtbetay),
                  GETVAR2(const CCTK_REAL, dtbetaz)},
-      gf_dtK1{GETVAR2(const CCTK_REAL, kxx), GETVAR2(const CCTK_REAL, kxy),
-              GETVAR2(const CCTK_REAL, kxz), GETVAR2(const CCTK_REAL, kyy),
-              GETVAR2(const CCTK_REAL, kyz), GETVAR2(const CCTK_REAL, kzz)},
+      gf_dtK1{GETVAR2(const CCTK_REAL, dtkxx), GETVAR2(const CCTK_REAL, dtkxy),
+              GETVAR2(const CCTK_REAL, dtkxz), GETVAR2(const CCTK_REAL, dtkyy),
+              GETVAR2(const CCTK_REAL, dtkyz), GETVAR2(const CCTK_REAL, dtkzz)},
       gf_dt2alpha1(GETVAR2(const CCTK_REAL, dt2alp)),
       gf_dt2beta1{GETVAR2(const CCTK_REAL, dt2betax),
                   GETVAR2(const CCTK_REAL, dt2betay),
@@ -102,7 +102,7 @@ gfs_t::gfs_t(const cGH *const cctkGH)
       gf_Psi4re5(GETVAR5(CCTK_REAL, Psi4re)),
       gf_Psi4im5(GETVAR5(CCTK_REAL, Psi4im)),
       //
-      nvars(371), ivar(0), vars(layout0, nvars),
+      nvars(361), ivar(0), vars(layout0, nvars),
       //
       gf_alpha0(make_gf()), gf_dalpha0(make_vec_gf()),
       gf_ddalpha0(make_mat_gf()), gf_beta0(make_vec_gf()),
@@ -113,9 +113,6 @@ gfs_t::gfs_t(const cGH *const cctkGH)
       //
       gf_dtalpha0(make_gf()), gf_ddtalpha0(make_vec_gf()),
       gf_dtbeta0(make_vec_gf()), gf_ddtbeta0(make_vec_vec_gf()),
-      gf_dtK0(make_mat_gf()),
-      //
-      gf_dt2alpha0(make_gf()), gf_dt2beta0(make_vec_gf()),
       // Intermediate variables: 4-metric
       tile_g4(make_mat4_gf()), tile_dg4(make_mat4_vec4_gf()),
       tile_ddg4(make_mat4_mat4_gf()),
@@ -129,17 +126,7 @@ gfs_t::gfs_t(const cGH *const cctkGH)
                 "these. Update the definition of `nvars`.",
                 nvars, ivar);
 
-  calc_derivs2(cctkGH, gf_alpha1, gf_alpha0, gf_dalpha0, gf_ddalpha0, layout0);
-  calc_derivs2(cctkGH, gf_beta1, gf_beta0, gf_dbeta0, gf_ddbeta0, layout0);
-  calc_derivs2(cctkGH, gf_gamma1, gf_gamma0, gf_dgamma0, gf_ddgamma0, layout0);
-  calc_derivs(cctkGH, gf_K1, gf_K0, gf_dK0, layout0);
-
-  calc_derivs(cctkGH, gf_dtalpha1, gf_dtalpha0, gf_ddtalpha0, layout0);
-  calc_derivs(cctkGH, gf_dtbeta1, gf_dtbeta0, gf_ddtbeta0, layout0);
-  calc_copy(cctkGH, gf_dtK1, gf_dtK0, layout0);
-
-  calc_copy(cctkGH, gf_dt2alpha1, gf_dt2alpha0, layout0);
-  calc_copy(cctkGH, gf_dt2beta1, gf_dt2beta0, layout0);
+  calc_derivatives();
 }
 
 #undef GETVAR2
@@ -153,6 +140,11 @@ extern "C" void Weyl_Weyl(CCTK_ARGUMENTS) {
     if (cctk_nghostzones[d] < deriv_order / 2 + 1)
       CCTK_VERROR("Need at least %d ghost zones", deriv_order / 2 + 1);
 
+  if (!patch_is_selected(cctkGH)) {
+    mask_scalars(cctkGH);
+    return;
+  }
+
   {
     const std::array<int, dim> nghostzones{cctkGH->cctk_nghostzones[0],
                                            cctkGH->cctk_nghostzones[1],
@@ -150,11 +150,8 @@ public:
   vec<GF3D5<CCTK_REAL>, 3> gf_dtbeta0;
   vec<vec<GF3D5<CCTK_REAL>, 3>, 3> gf_ddtbeta0;
 
-  smat<GF3D5<CCTK_REAL>, 3> gf_dtK0;
-
-  GF3D5<CCTK_REAL> gf_dt2alpha0;
-
-  vec<GF3D5<CCTK_REAL>, 3> gf_dt2beta0;
+  // dtK, dt2alpha, and dt2beta are not differentiated; they are read
+  // directly from the input grid functions
 
   // Intermediate variables: 4-metric
 
@@ -178,11 +175,20 @@ public:
 
   gfs_t(const cGH *cctkGH);
 
+  template <int deriv_order> void calc_derivatives() const;
+  void calc_derivatives() const;
   void calc_metric() const;
   void calc_curvature() const;
   void calc_scalars() const;
 };
 
+// Whether the Weyl scalars should be calculated on the current patch,
+// as selected by refinement level and extraction shells
+bool patch_is_selected(const cGH *cctkGH);
+
+// Set the Weyl scalars on the current patch to zero
+void mask_scalars(const cGH *cctkGH);
+
 } // namespace Weyl
 
 #endif // #ifndef WEYL_HXX
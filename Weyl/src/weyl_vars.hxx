@@ -362,8 +362,8 @@ template <typename T> struct weyl_vars_curvature {
                       const smat<smat<T, 4>, 4> &ddg)
       : g(g), dg(dg), ddg(ddg),
         //
-        detg(min(1.0e+6, max(1.0e-6, calc_det(g)))), //
-        gu(calc_inv(g, detg)),                       //
+        detg(calc_det(g)),     //
+        gu(calc_inv(g, detg)), //
         //
         dgu(calc_dgu(gu, dg)),
         //
@@ -572,6 +572,142 @@ template <typename T> struct weyl_vars_scalars {
   {}
 };
 
+// Weyl scalars from the 3+1 split of the Weyl tensor into its electric
+// and magnetic parts, which needs neither the 4-metric nor any time
+// derivatives. The tetrad is the one used above, with the time leg
+// being the (past-directed) unit normal.
+template <typename T> struct weyl_vars_3p1 {
+
+  // Position
+  const vec<T, 3> coord;
+
+  // ADM variables
+  const smat<T, 3> gamma;
+  const smat<T, 3> gu;
+  const vec<smat<T, 3>, 3> Gamma;
+  const smat<T, 3> K;
+  const smat<vec<T, 3>, 3> dK;
+  const smat<T, 3> R;
+
+  // Matter variables
+  const vec<T, 3> Si;
+  const smat<T, 3> Sij;
+
+  // Intermediate quantities
+  const T trK;
+  const smat<vec<T, 3>, 3> DK;
+
+  // Electric part of the Weyl tensor
+  const smat<T, 3> E;
+
+  // Spatial triad
+  const vec<T, 3> ephi, etheta, er;
+  const vec<cplx<T>, 3> m, mb;
+
+  // Weyl scalars
+  const cplx<T> Psi0, Psi1, Psi2, Psi3, Psi4;
+
+private:
+  template <typename U, typename V>
+  static inline ARITH_INLINE ARITH_DEVICE ARITH_HOST auto
+  contract(const smat<T, 3> &A, const vec<U, 3> &u, const vec<V, 3> &v) {
+    return sum<3>([&](int a) ARITH_INLINE {
+      return u(a) * sum<3>([&](int b) ARITH_INLINE { return A(a, b) * v(b); });
+    });
+  }
+
+  template <typename U, typename V, typename W>
+  static inline ARITH_INLINE ARITH_DEVICE ARITH_HOST auto
+  contract(const smat<vec<T, 3>, 3> &A, const vec<U, 3> &u,
+           const vec<V, 3> &v, const vec<W, 3> &w) {
+    // A_ij,k u^i v^j w^k
+    return sum<3>([&](int c) ARITH_INLINE {
+      return w(c) * sum<3>([&](int a) ARITH_INLINE {
+               return u(a) * sum<3>([&](int b) ARITH_INLINE {
+                        return A(a, b)(c) * v(b);
+                      });
+             });
+    });
+  }
+
+  template <typename U>
+  static inline ARITH_INLINE ARITH_DEVICE ARITH_HOST auto
+  contract(const vec<T, 3> &A, const vec<U, 3> &u) {
+    return sum<3>([&](int a) ARITH_INLINE { return A(a) * u(a); });
+  }
+
+public:
+  inline ARITH_INLINE ARITH_DEVICE ARITH_HOST
+  weyl_vars_3p1(const vec<T, 3> &coord, const smat<T, 3> &gamma,
+                const smat<T, 3> &gu, const vec<smat<T, 3>, 3> &Gamma,
+                const smat<T, 3> &K, const smat<vec<T, 3>, 3> &dK,
+                const smat<T, 3> &R, const vec<T, 3> &Si,
+                const smat<T, 3> &Sij)
+      : coord(coord), gamma(gamma), gu(gu), Gamma(Gamma), K(K), dK(dK), R(R),
+        Si(Si), Sij(Sij),
+        //
+        trK(calc_trace(K, gu)),
+        // D_k K_ij
+        DK([&](int a, int b) ARITH_INLINE {
+          return vec<T, 3>([&](int c) ARITH_INLINE {
+            return dK(a, b)(c) //
+                   - sum<3>([&](int x) ARITH_INLINE {
+                       return Gamma(x)(c, a) * K(x, b) //
+                              + Gamma(x)(c, b) * K(a, x);
+                     });
+          });
+        }),
+        // Alcubierre (8.3.15), trace-free
+        E([&]() ARITH_INLINE {
+          const smat<T, 3> E0([&](int a, int b) ARITH_INLINE {
+            return R(a, b) + trK * K(a, b) //
+                   - sum<3>([&](int x) ARITH_INLINE {
+                       return K(a, x) * sum<3>([&](int y) ARITH_INLINE {
+                                return gu(x, y) * K(y, b);
+                              });
+                     }) //
+                   - 4 * T(M_PI) * Sij(a, b);
+          });
+          const T trE0 = calc_trace(E0, gu);
+          return smat<T, 3>([&](int a, int b) ARITH_INLINE {
+            return E0(a, b) - trE0 / 3 * gamma(a, b);
+          });
+        }()),
+        //
+        ephi(calc_ephi(coord, gamma)),           //
+        etheta(calc_etheta(coord, gamma, ephi)), //
+        er(calc_er(coord, gamma, etheta, ephi)), //
+        m([&](int a) ARITH_INLINE {
+          return cplx<T>(etheta(a), ephi(a)) / sqrt(T(2));
+        }),
+        mb([&](int a) ARITH_INLINE { return conj(m(a)); }),
+        // The magnetic part enters via the Codazzi equation,
+        //   C(n,i,j,k) = D_j K_ik - D_k K_ij
+        //                + 4 pi (gamma_ik S_j - gamma_ij S_k)
+        Psi0(contract(E, m, m)             //
+             + contract(DK, m, er, m)      //
+             - contract(DK, m, m, er)),    //
+        Psi1((contract(DK, er, m, er)      //
+              - contract(DK, er, er, m)    //
+              - 4 * T(M_PI) * contract(Si, m) //
+              - contract(E, er, m)) /
+             sqrt(T(2))),
+        Psi2((contract(E, er, er)          //
+              + contract(DK, m, er, mb)    //
+              - contract(DK, mb, er, m)) / //
+             T(2)),
+        Psi3((contract(E, er, mb)           //
+              + contract(DK, er, mb, er)    //
+              - contract(DK, er, er, mb)    //
+              - 4 * T(M_PI) * contract(Si, mb)) /
+             sqrt(T(2))),
+        Psi4(contract(E, mb, mb)          //
+             - contract(DK, mb, er, mb)   //
+             + contract(DK, mb, mb, er))
+  //
+  {}
+};
+
 } // namespace Weyl
 
 #endif // #ifndef WEYL_VARS_HXX
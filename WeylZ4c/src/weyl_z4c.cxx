@@ -0,0 +1,246 @@
+#include <cctk.h>
+
+#ifdef __CUDACC__
+// Disable CCTK_DEBUG since the debug information takes too much
+// parameter space to launch the kernels
+#ifdef CCTK_DEBUG
+#undef CCTK_DEBUG
+#endif
+#endif
+
+#include <weyl.hxx>
+#include <weyl_vars.hxx>
+#include <z4c_vars.hxx>
+
+#include <cplx.hxx>
+#include <loop_device.hxx>
+#include <mat.hxx>
+#include <simd.hxx>
+#include <vec.hxx>
+
+#include <cctk.h>
+#include <cctk_Arguments.h>
+#include <cctk_Parameters.h>
+
+#include <cmath>
+
+namespace Weyl {
+using namespace Arith;
+using namespace Loop;
+using namespace std;
+
+// Calculate the Weyl scalars directly from the Z4c state vectors. This
+// avoids the detour via the ADMBase variables, and in particular
+// needs no second time derivatives of lapse and shift.
+extern "C" void WeylZ4c_Weyl(CCTK_ARGUMENTS) {
+  DECLARE_CCTK_ARGUMENTS_WeylZ4c_Weyl;
+
+  for (int d = 0; d < 3; ++d)
+    if (cctk_nghostzones[d] < Z4c::deriv_order / 2 + 1)
+      CCTK_VERROR("Need at least %d ghost zones", Z4c::deriv_order / 2 + 1);
+
+  if (!patch_is_selected(cctkGH)) {
+    mask_scalars(cctkGH);
+    return;
+  }
+
+  //
+
+  const array<int, dim> indextype = {0, 0, 0};
+  const array<int, dim> nghostzones = {cctk_nghostzones[0], cctk_nghostzones[1],
+                                       cctk_nghostzones[2]};
+  vect<int, dim> imin, imax;
+  GridDescBase(cctkGH).box_int<0, 0, 0>(nghostzones, imin, imax);
+  // Suffix 1: with ghost zones, suffix 0: without ghost zones
+  const GF3D2layout layout1(cctkGH, indextype);
+  const GF3D5layout layout0(imin, imax);
+
+  const GF3D2<const CCTK_REAL> gf_chi1(layout1, chi);
+
+  const smat<GF3D2<const CCTK_REAL>, 3> gf_gammat1{
+      GF3D2<const CCTK_REAL>(layout1, gammatxx),
+      GF3D2<const CCTK_REAL>(layout1, gammatxy),
+      GF3D2<const CCTK_REAL>(layout1, gammatxz),
+      GF3D2<const CCTK_REAL>(layout1, gammatyy),
+      GF3D2<const CCTK_REAL>(layout1, gammatyz),
+      GF3D2<const CCTK_REAL>(layout1, gammatzz)};
+
+  const GF3D2<const CCTK_REAL> gf_Kh1(layout1, Kh);
+
+  const smat<GF3D2<const CCTK_REAL>, 3> gf_At1{
+      GF3D2<const CCTK_REAL>(layout1, Atxx),
+      GF3D2<const CCTK_REAL>(layout1, Atxy),
+      GF3D2<const CCTK_REAL>(layout1, Atxz),
+      GF3D2<const CCTK_REAL>(layout1, Atyy),
+      GF3D2<const CCTK_REAL>(layout1, Atyz),
+      GF3D2<const CCTK_REAL>(layout1, Atzz)};
+
+  const vec<GF3D2<const CCTK_REAL>, 3> gf_Gamt1{
+      GF3D2<const CCTK_REAL>(layout1, Gamtx),
+      GF3D2<const CCTK_REAL>(layout1, Gamty),
+      GF3D2<const CCTK_REAL>(layout1, Gamtz)};
+
+  const GF3D2<const CCTK_REAL> gf_Theta1(layout1, Theta);
+
+  const GF3D2<const CCTK_REAL> gf_alphaG1(layout1, alphaG);
+
+  const vec<GF3D2<const CCTK_REAL>, 3> gf_betaG1{
+      GF3D2<const CCTK_REAL>(layout1, betaGx),
+      GF3D2<const CCTK_REAL>(layout1, betaGy),
+      GF3D2<const CCTK_REAL>(layout1, betaGz)};
+
+  //
+
+  // The gauge variables are only needed to convert T_munu to the
+  // matter sources; their derivatives do not enter the Weyl scalars.
+  const int ntmps = 114;
+  GF3D5vector<CCTK_REAL> tmps(layout0, ntmps);
+  int itmp = 0;
+
+  const auto make_gf = [&]() { return GF3D5<CCTK_REAL>(tmps(itmp++)); };
+  const auto make_vec = [&](const auto &f) {
+    return vec<result_of_t<decltype(f)()>, 3>([&](int) { return f(); });
+  };
+  const auto make_mat = [&](const auto &f) {
+    return smat<result_of_t<decltype(f)()>, 3>([&](int, int) { return f(); });
+  };
+  const auto make_vec_gf = [&]() { return make_vec(make_gf); };
+  const auto make_mat_gf = [&]() { return make_mat(make_gf); };
+  const auto make_vec_vec_gf = [&]() { return make_vec(make_vec_gf); };
+  const auto make_mat_vec_gf = [&]() { return make_mat(make_vec_gf); };
+  const auto make_mat_mat_gf = [&]() { return make_mat(make_mat_gf); };
+
+  const GF3D5<CCTK_REAL> gf_chi0(make_gf());
+  const vec<GF3D5<CCTK_REAL>, 3> gf_dchi0(make_vec_gf());
+  const smat<GF3D5<CCTK_REAL>, 3> gf_ddchi0(make_mat_gf());
+  Z4c::calc_derivs2(cctkGH, gf_chi1, gf_chi0, gf_dchi0, gf_ddchi0, layout0);
+
+  const smat<GF3D5<CCTK_REAL>, 3> gf_gammat0(make_mat_gf());
+  const smat<vec<GF3D5<CCTK_REAL>, 3>, 3> gf_dgammat0(make_mat_vec_gf());
+  const smat<smat<GF3D5<CCTK_REAL>, 3>, 3> gf_ddgammat0(make_mat_mat_gf());
+  Z4c::calc_derivs2(cctkGH, gf_gammat1, gf_gammat0, gf_dgammat0, gf_ddgammat0,
+                    layout0);
+
+  const GF3D5<CCTK_REAL> gf_Kh0(make_gf());
+  const vec<GF3D5<CCTK_REAL>, 3> gf_dKh0(make_vec_gf());
+  Z4c::calc_derivs(cctkGH, gf_Kh1, gf_Kh0, gf_dKh0, layout0);
+
+  const smat<GF3D5<CCTK_REAL>, 3> gf_At0(make_mat_gf());
+  const smat<vec<GF3D5<CCTK_REAL>, 3>, 3> gf_dAt0(make_mat_vec_gf());
+  Z4c::calc_derivs(cctkGH, gf_At1, gf_At0, gf_dAt0, layout0);
+
+  const vec<GF3D5<CCTK_REAL>, 3> gf_Gamt0(make_vec_gf());
+  const vec<vec<GF3D5<CCTK_REAL>, 3>, 3> gf_dGamt0(make_vec_vec_gf());
+  Z4c::calc_derivs(cctkGH, gf_Gamt1, gf_Gamt0, gf_dGamt0, layout0);
+
+  const GF3D5<CCTK_REAL> gf_Theta0(make_gf());
+  const vec<GF3D5<CCTK_REAL>, 3> gf_dTheta0(make_vec_gf());
+  Z4c::calc_derivs(cctkGH, gf_Theta1, gf_Theta0, gf_dTheta0, layout0);
+
+  if (itmp != ntmps)
+    CCTK_VERROR("Wrong number of temporary variables: ntmps=%d itmp=%d", ntmps,
+                itmp);
+  itmp = -1;
+
+  //
+
+  const GF3D2<const CCTK_REAL> gf_eTtt1(layout1, eTtt);
+
+  const vec<GF3D2<const CCTK_REAL>, 3> gf_eTti1{
+      GF3D2<const CCTK_REAL>(layout1, eTtx),
+      GF3D2<const CCTK_REAL>(layout1, eTty),
+      GF3D2<const CCTK_REAL>(layout1, eTtz)};
+
+  const smat<GF3D2<const CCTK_REAL>, 3> gf_eTij1{
+      GF3D2<const CCTK_REAL>(layout1, eTxx),
+      GF3D2<const CCTK_REAL>(layout1, eTxy),
+      GF3D2<const CCTK_REAL>(layout1, eTxz),
+      GF3D2<const CCTK_REAL>(layout1, eTyy),
+      GF3D2<const CCTK_REAL>(layout1, eTyz),
+      GF3D2<const CCTK_REAL>(layout1, eTzz)};
+
+  //
+
+  const GF3D2<CCTK_REAL> gf_Psi0re1(layout1, Psi0re);
+  const GF3D2<CCTK_REAL> gf_Psi0im1(layout1, Psi0im);
+  const GF3D2<CCTK_REAL> gf_Psi1re1(layout1, Psi1re);
+  const GF3D2<CCTK_REAL> gf_Psi1im1(layout1, Psi1im);
+  const GF3D2<CCTK_REAL> gf_Psi2re1(layout1, Psi2re);
+  const GF3D2<CCTK_REAL> gf_Psi2im1(layout1, Psi2im);
+  const GF3D2<CCTK_REAL> gf_Psi3re1(layout1, Psi3re);
+  const GF3D2<CCTK_REAL> gf_Psi3im1(layout1, Psi3im);
+  const GF3D2<CCTK_REAL> gf_Psi4re1(layout1, Psi4re);
+  const GF3D2<CCTK_REAL> gf_Psi4im1(layout1, Psi4im);
+
+  //
+
+  typedef simd<CCTK_REAL> vreal;
+  typedef simdl<CCTK_REAL> vbool;
+  constexpr size_t vsize = tuple_size_v<vreal>;
+
+  const Loop::GridDescBaseDevice grid(cctkGH);
+
+  noinline([&]() __attribute__((__flatten__, __hot__)) {
+    grid.loop_int_device<0, 0, 0, vsize>(
+        grid.nghostzones, [=] ARITH_DEVICE(const PointDesc &p) ARITH_INLINE {
+          const vbool mask = mask_for_loop_tail<vbool>(p.i, p.imax);
+          const GF3D2index index1(layout1, p.I);
+          const GF3D5index index0(layout0, p.I);
+
+          const vreal alphaG = gf_alphaG1(mask, index1);
+          const vec<vreal, 3> betaG = gf_betaG1(mask, index1);
+
+          // Load and calculate
+          const Z4c::z4c_vars<vreal> vars(
+              false, 0, 0, 0, 0, 0, //
+              gf_chi0(mask, index0), gf_dchi0(mask, index0),
+              gf_ddchi0(mask, index0), //
+              gf_gammat0(mask, index0), gf_dgammat0(mask, index0),
+              gf_ddgammat0(mask, index0),                        //
+              gf_Kh0(mask, index0), gf_dKh0(mask, index0),       //
+              gf_At0(mask, index0), gf_dAt0(mask, index0),       //
+              gf_Gamt0(mask, index0), gf_dGamt0(mask, index0),   //
+              gf_Theta0(mask, index0), gf_dTheta0(mask, index0), //
+              alphaG, zero<vec<vreal, 3> >()(),
+              zero<smat<vreal, 3> >()(), //
+              betaG, zero<vec<vec<vreal, 3>, 3> >()(),
+              zero<vec<smat<vreal, 3>, 3> >()(), //
+              gf_eTtt1(mask, index1), gf_eTti1(mask, index1),
+              gf_eTij1(mask, index1));
+
+          // Spatial derivatives of the extrinsic curvature
+          //   K_ij = 1/(1+chi) (At_ij + (Kh + 2 Theta)/3 gammat_ij)
+          const smat<vec<vreal, 3>, 3> dK([&](int a, int b) ARITH_INLINE {
+            const vreal gammat_ab = vars.delta3(a, b) + vars.gammat(a, b);
+            return vec<vreal, 3>([&](int c) ARITH_INLINE {
+              return -vars.dchi(c) / (1 + vars.chi) * vars.K(a, b) //
+                     + (vars.dAt(a, b)(c)                          //
+                        + (vars.dKh(c) + 2 * vars.dTheta(c)) / 3 * gammat_ab //
+                        + (vars.Kh + 2 * vars.Theta) / 3 *
+                              vars.dgammat(a, b)(c)) /
+                           (1 + vars.chi);
+            });
+          });
+
+          const vec<vreal, 3> coord(
+              [&](int d) { return p.X[d] + iota<vreal>() * p.DX[d]; });
+
+          const weyl_vars_3p1<vreal> weylvars(coord, vars.g, vars.gu,
+                                              vars.Gamma, vars.K, dK, vars.R,
+                                              vars.Si, vars.Sij);
+
+          gf_Psi0re1.store(mask, index1, real(weylvars.Psi0));
+          gf_Psi0im1.store(mask, index1, imag(weylvars.Psi0));
+          gf_Psi1re1.store(mask, index1, real(weylvars.Psi1));
+          gf_Psi1im1.store(mask, index1, imag(weylvars.Psi1));
+          gf_Psi2re1.store(mask, index1, real(weylvars.Psi2));
+          gf_Psi2im1.store(mask, index1, imag(weylvars.Psi2));
+          gf_Psi3re1.store(mask, index1, real(weylvars.Psi3));
+          gf_Psi3im1.store(mask, index1, imag(weylvars.Psi3));
+          gf_Psi4re1.store(mask, index1, real(weylvars.Psi4));
+          gf_Psi4im1.store(mask, index1, imag(weylvars.Psi4));
+        });
+  });
+}
+
+} // namespace Weyl
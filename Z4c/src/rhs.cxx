@@ -330,29 +330,32 @@ extern "C" void Z4c_RHS(CCTK_ARGUMENTS) {
 
   // TODO: Consider fusing the loops to reduce memory bandwidth
 
-  apply_upwind_diss(cctkGH, gf_chi1, gf_betaG1, gf_chi_rhs1);
+  apply_upwind_diss(cctkGH, gf_chi1, gf_betaG1, gf_chi_rhs1, epsdiss);
 
   for (int a = 0; a < 3; ++a)
     for (int b = a; b < 3; ++b)
       apply_upwind_diss(cctkGH, gf_gammat1(a, b), gf_betaG1,
-                        gf_gammat_rhs1(a, b));
+                        gf_gammat_rhs1(a, b), epsdiss);
 
-  apply_upwind_diss(cctkGH, gf_Kh1, gf_betaG1, gf_Kh_rhs1);
+  apply_upwind_diss(cctkGH, gf_Kh1, gf_betaG1, gf_Kh_rhs1, epsdiss);
 
   for (int a = 0; a < 3; ++a)
     for (int b = a; b < 3; ++b)
-      apply_upwind_diss(cctkGH, gf_At1(a, b), gf_betaG1, gf_At_rhs1(a, b));
+      apply_upwind_diss(cctkGH, gf_At1(a, b), gf_betaG1, gf_At_rhs1(a, b),
+                        epsdiss);
 
   for (int a = 0; a < 3; ++a)
-    apply_upwind_diss(cctkGH, gf_Gamt1(a), gf_betaG1, gf_Gamt_rhs1(a));
+    apply_upwind_diss(cctkGH, gf_Gamt1(a), gf_betaG1, gf_Gamt_rhs1(a),
+                      epsdiss);
 
   if (!set_Theta_zero)
-    apply_upwind_diss(cctkGH, gf_Theta1, gf_betaG1, gf_Theta_rhs1);
+    apply_upwind_diss(cctkGH, gf_Theta1, gf_betaG1, gf_Theta_rhs1, epsdiss);
 
-  apply_upwind_diss(cctkGH, gf_alphaG1, gf_betaG1, gf_alphaG_rhs1);
+  apply_upwind_diss(cctkGH, gf_alphaG1, gf_betaG1, gf_alphaG_rhs1, epsdiss);
 
   for (int a = 0; a < 3; ++a)
-    apply_upwind_diss(cctkGH, gf_betaG1(a), gf_betaG1, gf_betaG_rhs1(a));
+    apply_upwind_diss(cctkGH, gf_betaG1(a), gf_betaG1, gf_betaG_rhs1(a),
+                      epsdiss);
 }
 
 } // namespace Z4c